@@ -0,0 +1,426 @@
+/***********************************************************
+ ** // UMBC - CMSC 341 - Fall 2024 - Proj4
+ ** File:    bench.cpp
+ ** Project: Fall 2024 - Proj4
+ ** Author:  Hazael Magino
+ ** Date:    11/26/2026
+ ** This file contains the micro benchmarks for the FileSys class
+ **********************************************************/
+#include "filesys.h"
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+unsigned int hashCode(const string str) {
+  unsigned int val = 0;
+  const unsigned int thirtyThree = 33; // magic number from textbook
+  for (unsigned int i = 0; i < str.length(); i++)
+    val = val * thirtyThree + str[i];
+  return val;
+}
+
+// Name: residentKB
+// Desc: Reads the resident set size of this process from /proc
+// Postconditions: Returns the resident memory in KB, or 0 if not available
+long residentKB() {
+  ifstream status("/proc/self/status");
+  string key;
+  while (status >> key) {
+    if (key == "VmRSS:") {
+      long kb = 0;
+      status >> kb;
+      return kb;
+    }
+  }
+  return 0;
+}
+
+// Name: secondsSince
+// Desc: Returns the elapsed wall clock time since start in seconds
+double secondsSince(chrono::steady_clock::time_point start) {
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+string namesDB[6] = {"driver.cpp", "test.cpp",        "test.h",
+                     "info.txt",   "mydocument.docx", "tempsheet.xlsx"};
+bool commonNames = false; // use namesDB instead of unique names
+cap_t capMode = PRIMECAP;  // capacity mode of the benchmarked table
+bool functorHash = false;  // hash with TextbookHash instead of hashCode
+store_t storeMode = FILESTORE; // storage mode of the benchmarked table
+bool orderedIndex = false;     // keep the ordered name index
+bool bulkInsert = false;       // insert the files with one bulkLoad
+bool batchInsert = false;      // insert the files with insertBatch
+bool reserveAll = false;       // reserve the table for every file first
+
+// Name: makeFileSys
+// Desc: Creates the benchmarked table with the hasher and capacity mode of
+// the command line, the caller deletes it
+FileSys *makeFileSys(prob_t probing) {
+  FileSys *filesys;
+  if (functorHash)
+    filesys = new FileSys(MINPRIME, TextbookHash(), probing, capMode, storeMode);
+  else
+    filesys = new FileSys(MINPRIME, hashCode, probing, capMode, storeMode);
+  if (orderedIndex)
+    filesys->enableOrderedIndex();
+  return filesys;
+}
+
+// Name: makeName
+// Desc: Builds a path-like file name, half of them short enough to fit in
+// the std::string small buffer and half of them long. With commonNames the
+// names repeat from namesDB and only the block tells the files apart.
+string makeName(int i) {
+  if (commonNames)
+    return namesDB[i % 6];
+  if (i % 2 == 0)
+    return "f" + to_string(i) + ".txt";
+  return "logs/2026-10/service/worker-" + to_string(i) + ".log";
+}
+
+// Name: benchLookup
+// Desc: Inserts numFiles files and then times hits and misses with getFile
+void benchLookup(int numFiles, prob_t probing) {
+  vector<File> files;
+  for (int i = 0; i < numFiles; i++) {
+    files.push_back(File(makeName(i), DISKMIN + (i % (DISKMAX - DISKMIN)), true));
+  }
+
+  vector<vector<File>> insertBatches;
+  for (int i = 0; batchInsert && i < numFiles; i += 1000) {
+    insertBatches.push_back(vector<File>(
+        files.begin() + i, files.begin() + min(numFiles, i + 1000)));
+  }
+
+  long rssBefore = residentKB();
+  FileSys *filesys = makeFileSys(probing);
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  if (bulkInsert) {
+    filesys->bulkLoad(files);
+  } else if (batchInsert) {
+    // the batches are cut outside of the timed loop
+    start = chrono::steady_clock::now();
+    for (const vector<File> &batch : insertBatches) {
+      filesys->insertBatch(batch);
+    }
+  } else {
+    for (int i = 0; i < numFiles; i++) {
+      filesys->insert(files[i]);
+    }
+  }
+  double insertSec = secondsSince(start);
+  long rssAfter = residentKB();
+
+  // look the files up in a different order than they were inserted in, so
+  // the heap order of the entries does not hide the cost of a random access
+  shuffle(files.begin(), files.end(), mt19937(10));
+
+  int found = 0;
+  start = chrono::steady_clock::now();
+  for (int round = 0; round < 4; round++) {
+    for (int i = 0; i < numFiles; i++) {
+      if (filesys->getFile(files[i].getName(), files[i].getDiskBlock())
+              .getUsed())
+        found++;
+    }
+  }
+  double hitSec = secondsSince(start);
+
+  int viewFound = 0;
+  start = chrono::steady_clock::now();
+  for (int round = 0; round < 4; round++) {
+    for (int i = 0; i < numFiles; i++) {
+      if (filesys->findFile(files[i].getName(), files[i].getDiskBlock()) !=
+          nullptr)
+        viewFound++;
+    }
+  }
+  double viewSec = secondsSince(start);
+
+  // the same lookups in batches of 256, like a directory listing asks for
+  vector<vector<FileKey>> batches;
+  for (int i = 0; i < numFiles; i += 256) {
+    batches.emplace_back();
+    for (int j = i; j < min(numFiles, i + 256); j++) {
+      batches.back().emplace_back(files[j].getName(), files[j].getDiskBlock());
+    }
+  }
+  size_t batchFound = 0;
+  const Slot *slots[256];
+  start = chrono::steady_clock::now();
+  for (int round = 0; round < 4; round++) {
+    for (const vector<FileKey> &batch : batches) {
+      batchFound += filesys->findFiles(batch.data(), batch.size(), slots);
+    }
+  }
+  double batchSec = secondsSince(start);
+
+  int missing = 0;
+  start = chrono::steady_clock::now();
+  for (int round = 0; round < 4; round++) {
+    for (int i = 0; i < numFiles; i++) {
+      if (!filesys->getFile(files[i].getName(), DISKMAX).getUsed())
+        missing++;
+    }
+  }
+  double missSec = secondsSince(start);
+
+  // every block of the run is owned by one file
+  int owned = 0;
+  start = chrono::steady_clock::now();
+  for (int round = 0; round < 4; round++) {
+    for (int i = 0; i < numFiles; i++) {
+      if (filesys->getFileByBlock(files[i].getDiskBlock()).getUsed())
+        owned++;
+    }
+  }
+  double blockSec = secondsSince(start);
+
+  cout << "policy " << probing << ": " << numFiles << " files" << endl;
+  cout << "  insert:  " << numFiles / insertSec / 1e6 << " M ops/s" << endl;
+  cout << "  hit:     " << 4.0 * numFiles / hitSec / 1e6 << " M lookups/s ("
+       << found << " found)" << endl;
+  cout << "  findFile:" << 4.0 * numFiles / viewSec / 1e6 << " M lookups/s ("
+       << viewFound << " found)" << endl;
+  cout << "  batch:   " << 4.0 * numFiles / batchSec / 1e6 << " M lookups/s ("
+       << batchFound << " found)" << endl;
+  cout << "  miss:    " << 4.0 * numFiles / missSec / 1e6 << " M lookups/s ("
+       << missing << " missing)" << endl;
+  cout << "  byBlock: " << 4.0 * numFiles / blockSec / 1e6 << " M lookups/s ("
+       << owned << " found)" << endl;
+  cout << "  table:   " << (rssAfter - rssBefore) / 1024.0 << " MB resident"
+       << endl;
+
+  // the long names with a worker number starting with 1, about 1/9 of them
+  size_t scanned = 0;
+  start = chrono::steady_clock::now();
+  filesys->scanPrefix("logs/2026-10/service/worker-1",
+                      [&scanned](const string &, int) { scanned++; });
+  cout << "  scan:    " << secondsSince(start) * 1e3 << " ms for a prefix ("
+       << scanned << " files)" << endl;
+
+  // every stored file once, by the callback and by the iterator
+  size_t each = 0;
+  start = chrono::steady_clock::now();
+  filesys->forEach([&each](const string &, int) { each++; });
+  double eachSec = secondsSince(start);
+  size_t walked = 0;
+  start = chrono::steady_clock::now();
+  for (FileSys::LiveIterator it = filesys->begin(); it != filesys->end(); ++it)
+    walked += it.getDiskBlock() != 0;
+  cout << "  walk:    " << eachSec * 1e3 << " ms forEach, "
+       << secondsSince(start) * 1e3 << " ms iterator (" << each << ", "
+       << walked << " files)" << endl;
+
+  if (commonNames) {
+    // every name is stored under numFiles / 6 blocks
+    size_t blocks = 0;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < 6; i++) {
+      blocks += filesys->findAll(namesDB[i]).size();
+    }
+    cout << "  findAll: " << secondsSince(start) * 1e3 / 6 << " ms per name ("
+         << blocks << " blocks)" << endl;
+  }
+  delete filesys;
+}
+
+// Name: benchGrowth
+// Desc: Inserts numFiles files into a table that starts at MINPRIME and
+// reports the insert rate and resident memory every time the count doubles.
+// The files are not kept, so the run scales to tens of millions of files.
+void benchGrowth(int numFiles, prob_t probing) {
+  FileSys *filesys = makeFileSys(probing);
+  long rssBefore = residentKB();
+  if (reserveAll) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    filesys->reserve(numFiles, true);
+    cout << "  reserve: " << secondsSince(start) << " s" << endl;
+  }
+
+  cout << "policy " << probing << ": growing to " << numFiles << " files"
+       << endl;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  chrono::steady_clock::time_point stepStart = start;
+  int stepFiles = 0;
+  int report = 1024;
+  for (int i = 0; i < numFiles; i++) {
+    filesys->insert(File(makeName(i), DISKMIN + (i % (DISKMAX - DISKMIN)), true));
+    stepFiles++;
+    if (i + 1 == report || i + 1 == numFiles) {
+      cout << "  " << i + 1 << " files: "
+           << stepFiles / secondsSince(stepStart) / 1e6 << " M ops/s, "
+           << secondsSince(start) << " s total, "
+           << (residentKB() - rssBefore) / 1024.0 << " MB resident" << endl;
+      report *= 2;
+      stepFiles = 0;
+      stepStart = chrono::steady_clock::now();
+    }
+  }
+
+  // every file must still be there after all the rehashes
+  int missing = 0;
+  for (int i = 0; i < numFiles; i += 997) {
+    if (!filesys->getFile(makeName(i), DISKMIN + (i % (DISKMAX - DISKMIN)))
+             .getUsed())
+      missing++;
+  }
+  cout << "  sampled lookups missing: " << missing << endl;
+  delete filesys;
+}
+
+// Name: benchAllocator
+// Desc: Creates numFiles files on blocks picked by the allocator, removes
+// every other one and creates them again, so the second round allocates from
+// a fragmented bitmap
+void benchAllocator(int numFiles, prob_t probing) {
+  FileSys *filesys = makeFileSys(probing);
+  vector<File> files;
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (int i = 0; i < numFiles; i++) {
+    string name = makeName(i);
+    int block = filesys->create(name);
+    files.push_back(File(name, block, true));
+  }
+  double createSec = secondsSince(start);
+
+  for (int i = 0; i < numFiles; i += 2) {
+    filesys->remove(files[i]);
+  }
+  start = chrono::steady_clock::now();
+  float fragmentation = filesys->fragmentation();
+  double fragSec = secondsSince(start);
+
+  start = chrono::steady_clock::now();
+  int created = 0;
+  for (int i = 0; i < numFiles; i += 2) {
+    if (filesys->create(files[i].getName()) != 0)
+      created++;
+  }
+  double refillSec = secondsSince(start);
+
+  cout << "policy " << probing << ": " << numFiles << " created files" << endl;
+  cout << "  create:  " << numFiles / createSec / 1e6 << " M ops/s" << endl;
+  cout << "  refill:  " << created / refillSec / 1e6 << " M ops/s ("
+       << created << " created)" << endl;
+  cout << "  fragmentation " << fragmentation << " in " << fragSec * 1e3
+       << " ms, " << filesys->freeBlocks() << " free blocks" << endl;
+  delete filesys;
+}
+
+// Name: benchLatency
+// Desc: Inserts numFiles files into a table that starts at MINPRIME once for
+// every migration step budget and times every insert on its own, so the
+// inserts that take a migration step show up in the tail. An insert that
+// rehashes allocates the new table and one that brings the count to a power
+// of two doubles the name index, their time is reported apart.
+void benchLatency(int numFiles, prob_t probing) {
+  const step_t modes[4] = {QUARTERSTEP, SLOTSTEP, MOVESTEP, TIMESTEP};
+  const size_t amounts[4] = {0, 1024, 256, 20000};
+  const char *labels[4] = {"quarter", "1024 slots", "256 moves", "20 us"};
+  vector<File> files;
+  for (int i = 0; i < numFiles; i++) {
+    files.push_back(File(makeName(i), DISKMIN + (i % (DISKMAX - DISKMIN)), true));
+  }
+
+  cout << "policy " << probing << ": " << numFiles
+       << " timed inserts (ns per insert)" << endl;
+  vector<long long> times(numFiles);
+  for (int m = 0; m < 4; m++) {
+    FileSys *filesys = makeFileSys(probing);
+    filesys->setMigrationStep(modes[m], amounts[m]);
+    long long maxGrow = 0;
+    int timed = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < numFiles; i++) {
+      float lambda = filesys->lambda();
+      chrono::steady_clock::time_point before = chrono::steady_clock::now();
+      filesys->insert(files[i]);
+      long long ns = chrono::duration_cast<chrono::nanoseconds>(
+                         chrono::steady_clock::now() - before)
+                         .count();
+      if (filesys->lambda() < lambda || ((i + 1) & i) == 0)
+        maxGrow = max(maxGrow, ns);
+      else
+        times[timed++] = ns;
+    }
+    double total = secondsSince(start);
+    sort(times.begin(), times.begin() + timed);
+    cout << "  " << labels[m] << ": " << total << " s, p50 "
+         << times[timed / 2] << ", p99 " << times[(size_t)(timed * 0.99)]
+         << ", p99.9 " << times[(size_t)(timed * 0.999)] << ", max "
+         << times[timed - 1] << ", max grow " << maxGrow << endl;
+    delete filesys;
+  }
+}
+
+// usage: ./bench [numFiles] [policy] [names|grow|pow2|functor|group|alloc|ordered|bulk|batch|reserve|latency]...
+// with "names" the files share the names of namesDB
+// with "grow" only the inserts are timed, ./bench 50000000 3 grow inserts 50M
+// files (this needs about 10 GB of memory)
+// with "pow2" the table uses power of two capacities
+// with "functor" the names are hashed by TextbookHash instead of hashCode
+// with "group" the files of a name share one slot (GROUPSTORE)
+// with "alloc" the files are created on blocks picked by the allocator
+// with "ordered" the table keeps the ordered name index
+// with "bulk" the files are inserted with bulkLoad
+// with "batch" the files are inserted with insertBatch, 1000 at a time
+// with "reserve" the grow run reserves the table for every file first
+// with "latency" every insert of a growing table is timed for each budget
+// of a migration step
+// every run measures a single policy so the resident memory of one table
+// is not hidden by memory the allocator kept from a previous table
+int main(int argc, char *argv[]) {
+  int numFiles = 40000;
+  prob_t probing = QUADRATIC;
+  bool growth = false;
+  bool allocator = false;
+  bool latency = false;
+  if (argc > 1)
+    numFiles = atoi(argv[1]);
+  if (argc > 2)
+    probing = (prob_t)atoi(argv[2]);
+  for (int i = 3; i < argc; i++) {
+    string option = argv[i];
+    if (option == "names")
+      commonNames = true;
+    else if (option == "grow")
+      growth = true;
+    else if (option == "pow2")
+      capMode = POW2CAP;
+    else if (option == "functor")
+      functorHash = true;
+    else if (option == "group")
+      storeMode = GROUPSTORE;
+    else if (option == "alloc")
+      allocator = true;
+    else if (option == "ordered")
+      orderedIndex = true;
+    else if (option == "bulk")
+      bulkInsert = true;
+    else if (option == "batch")
+      batchInsert = true;
+    else if (option == "reserve")
+      reserveAll = true;
+    else if (option == "latency")
+      latency = true;
+  }
+
+  if (growth) {
+    benchGrowth(numFiles, probing);
+  } else if (latency) {
+    benchLatency(numFiles, probing);
+  } else if (allocator) {
+    benchAllocator(numFiles, probing);
+  } else {
+    benchLookup(numFiles, probing);
+  }
+  return 0;
+}
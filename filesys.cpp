@@ -7,6 +7,42 @@
  ** This file contains the proper implementations for filesys.cpp
  **********************************************************/
 #include "filesys.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// A name that matches every stored name, the lookups of getFileByBlock find a
+// file by its hash value and block alone. It is told apart by its address.
+static const char ANYNAME[] = "";
+
+// Name: sameName
+// Desc: Compares a stored name with the name of a lookup, ANYNAME matches
+// every name.
+static inline bool sameName(const string &stored, string_view name) {
+  return name.data() == ANYNAME || stored == name;
+}
+
+// Name: FileSys::FileSys
+// Desc: Constructor for the FileSys class that takes a hash function of a
+// string. The name is copied for every hash, the constructor that takes a
+// view_hash_fn (or a hasher functor) avoids that. Parameters:
+//    - size: the desired size of the current hash table
+//    - hash: function pointer to the hash function
+//    - probing: specifies the collision handling policy (defaults to
+//    DEFPOLCY)
+//    - capMode: PRIMECAP or POW2CAP (defaults to PRIMECAP)
+//    - storeMode: FILESTORE or GROUPSTORE (defaults to FILESTORE)
+// Postconditions:
+//    - The table is set up like the view_hash_fn constructor does and hashes
+//    with hash.
+FileSys::FileSys(size_t size, hash_fn hash, prob_t probing = DEFPOLCY,
+                 cap_t capMode, store_t storeMode)
+    : FileSys(size, (view_hash_fn) nullptr, probing, capMode, storeMode) {
+  m_hash = hash;
+}
 
 // Name: FileSys::FileSys
 // Desc: Constructor for the FileSys class, initializes the hash table with a
@@ -15,50 +51,75 @@
 //    - hash: function pointer to the hash function
 //    - probing: specifies the collision handling policy (defaults to
 //    DEFPOLCY)
-// Preconditions: Size must be validated and set within the range [MINPRIME,
-// MAXPRIME] and adjusted to a prime number if necessary Postconditions:
+//    - capMode: PRIMECAP for prime capacities, POW2CAP for power of two
+//    capacities (defaults to PRIMECAP)
+//    - storeMode: FILESTORE for a slot per file, GROUPSTORE for a slot per
+//    name that holds the sorted blocks of the name (defaults to FILESTORE)
+// Preconditions: Size must be validated, at least MINPRIME, and adjusted to a
+// prime capacity of the table (or a power of two) if necessary
+// Postconditions:
 //    - The hash table is created with the specified or adjusted size
 //    - Member variables are initialized, including hash function and collision
 //    policy
-FileSys::FileSys(int size, hash_fn hash, prob_t probing = DEFPOLCY) {
+FileSys::FileSys(size_t size, view_hash_fn hash, prob_t probing,
+                 cap_t capMode, store_t storeMode) {
   // Debug statement: Start of the constructor
 
-  bool checkPrime = isPrime(size);
-  int checkSize = size;
+  TableCap checkSize;
 
-  // validate proper size
-  if (size < MINPRIME) {
-    checkSize = MINPRIME;
-  } else if (size > MAXPRIME) {
-    checkSize = MAXPRIME;
-  } else if (!checkPrime) {
-    checkSize = findNextPrime(size);
+  // validate proper size, there is no upper limit
+  if (capMode == POW2CAP) {
+    checkSize.m_cap = nextPowerOfTwo(size);
+  } else {
+    checkSize = primeCapAtLeast(size);
   }
 
-  // allocate memory for new table
-  m_currentTable = new File *[checkSize];
-
-  // intialize 2D-array with nullptr since an array of pointers is being used.
-  for (int i = 0; i < checkSize; i++) {
-    m_currentTable[i] = nullptr;
-  }
+  // allocate memory for new table, every slot starts out empty
+  m_currentTable = new Slot[checkSize.m_cap];
+  m_currCtrl = allocCtrl(checkSize.m_cap);
+  m_currHop = allocHop(checkSize.m_cap, probing);
 
   // initialize member variables
-  m_currentCap = checkSize;
+  m_currentCap = checkSize.m_cap;
+  m_currMagic = checkSize.m_magic;
   m_currentSize = 0;
   m_currNumDeleted = 0;
-  m_hash = hash;
+  m_hash = nullptr;
+  m_viewHash = hash;
   m_currProbing = probing;
 
   m_newPolicy = probing;
+  m_capMode = capMode;
+  m_storeMode = storeMode;
+  m_keyMask = (storeMode == GROUPSTORE) ? 0 : ~0;
 
   m_oldTable = nullptr;
+  m_oldCtrl = nullptr;
+  m_oldHop = nullptr;
+  m_oldMagic = 0;
   m_oldCap = 0;
   m_oldSize = 0;
   m_oldNumDeleted = 0;
   m_oldProbing = probing;
 
   m_transferIndex = 0;
+  m_stepMode = QUARTERSTEP;
+  m_stepAmount = 0;
+
+  // the name index starts with the capacity of the first table
+  m_namesCap = nextPowerOfTwo(m_currentCap);
+  m_names = new NameEntry[m_namesCap];
+  m_namesSize = 0;
+
+  m_ordered = nullptr;
+  m_iterators = 0;
+  // the block index and the allocator are built by the first block lookup
+  // or allocation
+  m_numUsedBlocks = 0;
+  m_allocWord = 0;
+  m_owners = nullptr;
+  m_usedBlocks = nullptr;
+  m_fullWords = nullptr;
 }
 
 // Name: FileSys::~FileSys
@@ -73,16 +134,24 @@ FileSys::FileSys(int size, hash_fn hash, prob_t probing = DEFPOLCY) {
 //    deallocated
 FileSys::~FileSys() {
 
-  // Cleanup current table
-  if (m_currentTable != nullptr) {
-    for (int i = 0; i < m_currentCap; ++i) {
-      if (m_currentTable[i] != nullptr) {
-        delete m_currentTable[i];
-      }
-    }
-    delete[] m_currentTable;
-    m_currentTable = nullptr;
-  }
+  // Cleanup current table, the files live inside the slots so a single
+  // delete releases the whole table
+  delete[] m_currentTable;
+  delete[] m_currCtrl;
+  delete[] m_currHop;
+  m_currentTable = nullptr;
+  m_currCtrl = nullptr;
+  m_currHop = nullptr;
+  delete[] m_names;
+  m_names = nullptr;
+  delete[] m_owners;
+  m_owners = nullptr;
+  delete[] m_usedBlocks;
+  delete[] m_fullWords;
+  m_usedBlocks = nullptr;
+  m_fullWords = nullptr;
+  delete m_ordered;
+  m_ordered = nullptr;
 
   // Cleanup old table
   cleanUpOldTable();
@@ -98,15 +167,30 @@ FileSys::~FileSys() {
 //    rehash
 void FileSys::changeProbPolicy(prob_t policy) { m_newPolicy = policy; }
 
+// Name: setMigrationStep
+// Desc: Sets the budget of a migration step. By default a step scans a
+// quarter of the old table, so the operation that starts a rehash and the
+// next three pay for a quarter of the table each. A smaller budget spreads
+// the same work over more operations. A step always scans at least
+// minTransfer slots, so the migration still ends before the current table
+// reaches its load limit. Parameters:
+//    - mode: QUARTERSTEP, SLOTSTEP, MOVESTEP or TIMESTEP
+//    - amount: slots scanned for SLOTSTEP, files moved for MOVESTEP,
+//    nanoseconds for TIMESTEP, not used for QUARTERSTEP
+// Postconditions:
+//    - Every following migration step stops once its budget is spent.
+void FileSys::setMigrationStep(step_t mode, size_t amount) {
+  m_stepMode = mode;
+  m_stepAmount = amount;
+}
+
 // Name: getNextIndex()
-// Desc: Applies the current probing policy to find the next index in the hash
-// table Parameters:
+// Desc: Applies the probing policy of a table to find the next index in the
+// hash table Parameters:
 //    - index: the current index calculated by the hash function
-//    - originalIndex: the original index calculated by the hash function (used
-//    for quadratic and double hashing)
 //    - jump: the current step count used in quadratic probing
 //    - cap: the capacity of the hash table
-//    - name: the name of the file (used for double hashing)
+//    - hashVal: the home index of the file (used for double hashing)
 //    - table: indicates which table we are working on
 // Preconditions:
 //    - The hash table must be properly initialized and have a capacity cap.
@@ -114,37 +198,49 @@ void FileSys::changeProbPolicy(prob_t policy) { m_newPolicy = policy; }
 //    QUADRATIC, or DOUBLEHASH.
 // Postconditions:
 //    - Returns the next index to check using the current probing policy.
-//    - Increments the step counter if using quadratic probing.
-int FileSys::getNextIndex(int index, int originalIndex, int &jump, int cap,
-                          int hashVal, int table) const {
-
-  if (table == 1) { // Indicates we are working on the current table
-    switch (m_currProbing) {
-    case QUADRATIC:
-      return quadraticProbing(originalIndex, jump, cap);
-    case DOUBLEHASH:
-      return doubleHashing(hashVal, jump, cap);
-    case LINEAR:
-      return linearProbing(index, cap);
-    default:
-      // Default case to handle unexpected probing policy
-      return 0; // for debugging purposes, should not happen however
-    }
-  } else if (table == 2) { // Indicates we are working on the old table
-    switch (m_oldProbing) {
-    case QUADRATIC:
-      return quadraticProbing(originalIndex, jump, cap);
-    case DOUBLEHASH:
-      return doubleHashing(hashVal, jump, cap);
-    case LINEAR:
-      return linearProbing(index, cap);
-    default:
-      // Default case to handle unexpected probing policy
-      return 0; // for debugging purposes, should not happen however
-    }
-  }
-
-  return 0; // Return 0 in case neither table condition is met
+//    - Every step is computed from the current index, so a probe never
+//    divides by the capacity.
+//    - The probe loops of the table do not call this function, they are
+//    instantiated per policy and call nextProbe directly.
+size_t FileSys::getNextIndex(size_t index, size_t &jump, size_t cap,
+                             size_t hashVal, int table) const {
+  prob_t probing = (table == 1) ? m_currProbing : m_oldProbing;
+  switch (probing) {
+  case QUADRATIC:
+    return nextProbe<QUADRATIC>(index, jump, cap, hashVal);
+  case DOUBLEHASH:
+    return nextProbe<DOUBLEHASH>(index, jump, cap, hashVal);
+  case LINEAR:
+    return nextProbe<LINEAR>(index, jump, cap, hashVal);
+  default:
+    // Default case to handle unexpected probing policy
+    return 0; // for debugging purposes, should not happen however
+  }
+}
+
+// Name: nextProbe
+// Desc: The probe step of a policy that is chosen at compile time, a probe
+// loop instantiated for one policy has no switch in its loop body.
+// Parameters:
+//    - index: the index of the previous probe
+//    - jump: the number of the probe, starting at 1
+//    - cap: the capacity of the hash table
+//    - hashVal: the home index of the file (used for double hashing)
+// Postconditions:
+//    - Returns the next index to check with the probing policy Policy.
+template <prob_t Policy>
+size_t FileSys::nextProbe(size_t index, size_t jump, size_t cap,
+                          size_t hashVal) const {
+  static_assert(Policy == QUADRATIC || Policy == DOUBLEHASH ||
+                    Policy == LINEAR,
+                "only the open addressing policies have a probe step");
+  if constexpr (Policy == QUADRATIC) {
+    return quadraticProbing(index, jump, cap);
+  } else if constexpr (Policy == DOUBLEHASH) {
+    return doubleHashing(index, hashVal, cap);
+  } else {
+    return linearProbing(index, cap);
+  }
 }
 
 // Name: linearProbing
@@ -157,32 +253,43 @@ int FileSys::getNextIndex(int index, int originalIndex, int &jump, int cap,
 // Postconditions:
 //    - Returns the next index to check using linear probing, ensuring it wraps
 //    around if it exceeds the table size.
-int FileSys::linearProbing(int index, int cap) const {
-  // Increment the index by 1 and take modulo with the table capacity to ensure
-  // it wraps around if it exceeds the table size
-  return ((index + 1) % cap);
+size_t FileSys::linearProbing(size_t index, size_t cap) const {
+  // Increment the index by 1 and wrap around at the end of the table, a
+  // compare is much cheaper than a modulo
+  return (index + 1 == cap) ? 0 : index + 1;
 }
 
 // Name: quadraticProbing
-// Desc: Resolves hash collisions using quadratic probing strategy
-// Parameters:
-//    - orgIndex: the initial index calculated by the hash function
+// Desc: Resolves hash collisions using quadratic probing strategy. A prime
+// table visits orgIndex + jump * jump, the offset grows by 2 * jump - 1 from
+// the previous probe. A power of two table visits the triangular numbers
+// orgIndex + jump * (jump + 1) / 2 instead, which reach every slot of the
+// table, the offset grows by jump. Parameters:
+//    - index: the index of the previous probe
 //    - jump: the current step count, used to calculate the quadratic offset
 //    - cap: the capacity of the hash table
 // Preconditions:
 //    - The hash table must be properly initialized and have a capacity cap.
+//    - jump is at most cap.
 // Postconditions:
 //    - Returns the next index to check using quadratic probing, ensuring it
 //    wraps around if it exceeds the table size.
-int FileSys::quadraticProbing(int orgIndex, int jump, int cap) const {
-  int nextIndex = (orgIndex + (jump * jump)) % cap;
-  return nextIndex;
+size_t FileSys::quadraticProbing(size_t index, size_t jump, size_t cap) const {
+  if (m_capMode == POW2CAP) {
+    return (index + jump) & (cap - 1);
+  }
+  size_t step = 2 * jump - 1;
+  if (step >= cap) {
+    step -= cap;
+  }
+  size_t nextIndex = index + step;
+  return (nextIndex >= cap) ? nextIndex - cap : nextIndex;
 }
 
 // Name: doubleHashing
 // Desc: Resolves hash collisions using double hashing strategy with the given
 // formula Parameters:
-//    - orgIndex: the initial index calculated by the first hash function
+//    - index: the index of the previous probe
 //    - hashVal: the hash value calculated by the first hash function
 //    - cap: the capacity of the hash table
 // Preconditions:
@@ -190,14 +297,68 @@ int FileSys::quadraticProbing(int orgIndex, int jump, int cap) const {
 // Postconditions:
 //    - Returns the next index to check using double hashing, ensuring it wraps
 //    around if it exceeds the table size.
-int FileSys::doubleHashing(int hashVal, int iteration, int cap) const {
-  //   index = ((Hash(key) % TableSize) + i x (11-(Hash(key) % 11))) % TableSize
-  //  Calculate the step size using the given formula
-
-  int nextIndex = ((hashVal % cap) + iteration * (11 - (hashVal) % 11)) % cap;
+size_t FileSys::doubleHashing(size_t index, size_t hashVal, size_t cap) const {
+  //   index = ((Hash(key) % TableSize) + i x (11-(Hash(key) % 11))) % TableSize
+  //  Every probe adds the same step, a modulo by the constant 11 compiles to a
+  //  multiplication. A power of two table needs an odd step to reach every
+  //  slot.
+  size_t step = 11 - hashVal % 11;
+  if (m_capMode == POW2CAP) {
+    return (index + (step | 1)) & (cap - 1);
+  }
   // Calculate the next index to check
-  return nextIndex;
+  size_t nextIndex = index + step;
+  return (nextIndex >= cap) ? nextIndex - cap : nextIndex;
+}
+
+// Name: homeIndex
+// Desc: Reduces a 32 bit hash value to a slot index of a table. A power of two
+// table keeps the low bits, a prime table computes value % cap with the fast
+// modulus of Lemire et al. from the constant saved with the table, two
+// multiplications instead of a division. Parameters:
+//    - value: the hash value to reduce
+//    - table: 1 for the current table, 2 for the old table
+// Postconditions:
+//    - Returns value % cap for a prime table, value & (cap - 1) otherwise.
+size_t FileSys::homeIndex(unsigned int value, int table) const {
+  size_t cap = (table == 1) ? m_currentCap : m_oldCap;
+  if (m_capMode == POW2CAP) {
+    return value & (cap - 1);
+  }
+  return fastMod(value, (table == 1) ? m_currMagic : m_oldMagic, cap);
+}
+
+// Name: fastMod
+// Desc: Computes value % cap from the fast modulus constant of cap, the low
+// 64 bits of magic * value hold the fraction of value / cap, multiplying them
+// by cap brings the remainder into the high 64 bits. Parameters:
+//    - value: the hash value to reduce
+//    - magic: the value of modMagic(cap)
+//    - cap: the capacity of a prime table
+// Postconditions:
+//    - Returns value % cap.
+size_t FileSys::fastMod(unsigned int value, uint64_t magic, size_t cap) {
+  if (magic == 0) {
+    return value; // the table is larger than any 32 bit hash value
+  }
+  uint64_t lowBits = magic * value;
+  return (uint64_t)(((__uint128_t)lowBits * cap) >> 64);
+}
+
+// Name: nextPowerOfTwo
+// Desc: Returns the capacity of a power of two table. Parameters:
+//    - current: the requested capacity
+// Postconditions:
+//    - Returns the smallest power of two that is at least current and at least
+//    MINPRIME.
+size_t FileSys::nextPowerOfTwo(size_t current) {
+  size_t cap = 1;
+  while (cap < current || cap < MINPRIME) {
+    cap <<= 1;
+  }
+  return cap;
 }
+
 // Name: insert
 // Desc: Inserts a file into the hash table using the current probing strategy
 // to resolve collisions. Parameters:
@@ -208,343 +369,1985 @@ int FileSys::doubleHashing(int hashVal, int iteration, int cap) const {
 //    - The hash table must be properly initialized and have sufficient
 //    capacity.
 // Postconditions:
-//    - Inserts the file into the hash table if it doesn't already exist.
+//    - Inserts the file into the hash table if it doesn't already exist, the
+//    name is copied once into the slot.
 //    - Updates the current size of the hash table.
 //    - Checks the load factor and initiates rehashing if necessary.
 //    - Returns true if the insertion is successful; false if the file already
 //    exists or insertion fails.
-bool FileSys::insert(File file) {
-  if (file.getDiskBlock() < DISKMIN || file.getDiskBlock() > DISKMAX) {
+bool FileSys::insert(const File &file) {
+  // The name is hashed once and the value is reused for both tables
+  unsigned int hashVal = hashName(file.m_name);
+  if (!isNewFile(file.m_name, file.m_diskBlock, hashVal) ||
+      !addNew(file, hashVal)) {
     return false;
   }
+  insertStep();
+  return true;
+}
 
-  int index = m_hash(file.getName()) % m_currentCap;
-  int originalIndex = index;
-  int jump = 0;
-
-  // Iterate to find a suitable slot
-  while (m_currentTable[index] != nullptr &&
-         m_currentTable[index]->getUsed() == true) {
-    File fileAtIndex = *m_currentTable[index];
-    if (fileAtIndex.getName() == file.getName() &&
-        fileAtIndex.getDiskBlock() == file.getDiskBlock()) {
-      return false; // Duplicate entry, do not insert
-    }
-    index = getNextIndex(index, originalIndex, jump, m_currentCap,
-                         originalIndex, 1);
-    jump++;
+// Name: insert
+// Desc: Inserts a file that the caller gives up, its name is moved into the
+// slot without a copy. Parameters:
+//    - file: the File object to be inserted into the hash table.
+// Postconditions:
+//    - Like insert(const File &). If the file is inserted, the name of file is
+//    moved from, otherwise file is unchanged.
+bool FileSys::insert(File &&file) {
+  unsigned int hashVal = hashName(file.m_name);
+  if (!isNewFile(file.m_name, file.m_diskBlock, hashVal) ||
+      !addNew(file, hashVal)) {
+    return false;
   }
+  insertStep();
+  return true;
+}
 
-  // Check if we need to allocate a new File object or replace the old one
-  if (m_currentTable[index] != nullptr) {
-    delete m_currentTable[index]; // Delete existing file to prevent memory leak
+// Name: addNew
+// Desc: Stores a file that isNewFile accepted without the rehash check, as a
+// block of its stored name in GROUPSTORE, otherwise in a slot of its own
+// with a copy of its name. Parameters:
+//    - file: the file to be stored
+//    - hashVal: the hash value of the name of the file
+// Postconditions:
+//    - Returns true if the file was stored.
+bool FileSys::addNew(const File &file, unsigned int hashVal) {
+  if (addBlock(file.m_name, file.m_diskBlock, hashVal)) {
+    return true;
   }
+  string name = file.m_name;
+  return addFile(name, file.m_diskBlock, hashVal);
+}
 
-  // Allocate new File and set it in the hash table
-  m_currentTable[index] = new File();
-  *m_currentTable[index] = file;
-  m_currentTable[index]->setUsed(true);
+// Name: addNew
+// Desc: addNew for a file the caller gives up, its name is moved into the
+// slot without a copy. Parameters:
+//    - file: the file to be stored
+//    - hashVal: the hash value of the name of the file
+// Postconditions:
+//    - Like addNew(const File &, unsigned int). If the file got a slot of
+//    its own, the name of file is moved from.
+bool FileSys::addNew(File &file, unsigned int hashVal) {
+  return addBlock(file.m_name, file.m_diskBlock, hashVal) ||
+         addFile(file.m_name, file.m_diskBlock, hashVal);
+}
 
-  if (m_currentTable[index]->getUsed() == false) {
-    m_currNumDeleted--;
-  } else {
-    m_currentSize++;
+// Name: emplace
+// Desc: Inserts a file given by its name and disk block, the name is
+// constructed once from name and then moved into its slot. Nothing is
+// allocated for a file that is rejected. Parameters:
+//    - name: the name of the file
+//    - block: the disk block number of the file
+// Postconditions:
+//    - Like insert(const File &).
+bool FileSys::emplace(string_view name, int block) {
+  unsigned int hashVal = hashName(name);
+  if (!isNewFile(name, block, hashVal)) {
+    return false;
   }
-
-  float loadFactor = lambda();
-  if (loadFactor > 0.5 && m_oldTable == nullptr) {
-    int currentNumData = getNumData();
-    int newCap = findNextPrime(4 * currentNumData);
-    rehash(newCap);
-  } else if (m_oldTable != nullptr) {
-    transferData();
+  bool stored = addBlock(name, block, hashVal);
+  if (!stored) {
+    string key(name);
+    stored = addFile(key, block, hashVal);
   }
-
-  return true;
+  if (stored) {
+    insertStep();
+  }
+  return stored;
 }
 
-// Name: getNumData
-// Desc: Returns the number of current data points in the hash table by
-// subtracting the number of deleted entries from the total size. Parameters:
-// None Preconditions:
-//    - The hash table must be properly initialized and have a valid
-//    m_currentSize and m_currNumDeleted.
+// Name: bulkLoad
+// Desc: Inserts many files at once. The table is sized for all of them
+// before the first one is stored, so the load stays below the limit and no
+// rehash starts during the load; a running migration is finished first.
+// When a live iterator holds the migration, the table cannot grow and the
+// files are inserted one by one, the ones the table has no room for are
+// refused like by insert. Duplicates within files and files already stored
+// are skipped by the lookup every insert makes. Names are copied only for
+// the files that are stored. Parameters:
+//    - files: the files to be inserted
+//    - byHome: true to store the files in the order of their home buckets
 // Postconditions:
-//    - Returns the count of live data points (excluding deleted entries) in the
-//    hash table.
-int FileSys::getNumData() const { return m_currentSize - m_currNumDeleted; }
+//    - Like an insert of every file of files, returns the number of files
+//    that were stored.
+size_t FileSys::bulkLoad(const vector<File> &files, bool byHome) {
+  return loadBatch(files, byHome);
+}
 
-// Name: rehash
-// Desc: Rehashes the hash table to a new capacity, transferring all live data
-// nodes from the current table to the new table incrementally. Parameters:
-//    - newCap: the new capacity for the hash table, which should be the
-//    smallest prime number greater than ((m_currentSize - m_currNumDeleted) *
-//    4).
-// Preconditions:
-//    - The hash table must be properly initialized and have a current capacity
-//    m_currentCap.
-//    - newCap should be a valid prime number greater than the current capacity
-//    adjusted for live data points.
+// Name: bulkLoad
+// Desc: bulkLoad for files the caller gives up, the names of the stored
+// files are moved into their slots instead of copied. Parameters:
+//    - files: the files to be inserted, the names of the stored ones are
+//    moved into their slots
+//    - byHome: true to store the files in the order of their home buckets
 // Postconditions:
-//    - Initiates the rehashing process, creating a new table with the specified
-//    capacity.
-//    - Starts transferring live data from the current table to the new table
-//    incrementally.
-//    - Updates the current table to the new table once the transfer is complete
-//    and deallocates the old table's memory.
-void FileSys::rehash(int newCap) {
-
-  // Save the current table and its properties to old variables
-  m_oldTable = m_currentTable;
-  m_oldCap = m_currentCap;
-  m_oldProbing = m_currProbing;
-  m_oldSize = m_currentSize;
-  m_oldNumDeleted = m_currNumDeleted;
+//    - Like bulkLoad(const vector<File> &, bool).
+size_t FileSys::bulkLoad(vector<File> &&files, bool byHome) {
+  return loadBatch(files, byHome);
+}
 
-  // If the current probing method is different from the new policy, update it
-  if (m_currProbing != m_newPolicy) {
-    m_currProbing = m_newPolicy;
+// Name: loadBatch
+// Desc: The body of both bulkLoads. The names are hashed once, then the
+// table is grown to the capacity a rehash would pick for the live files and
+// the new ones. With byHome the files are stored in the order of their home
+// buckets, by a counting sort on the top bits of the bucket, so the stores
+// and the probes of the duplicate check sweep the table from the front to
+// the back instead of jumping around it. Parameters:
+//    - files: the files to be inserted, a vector<File> or a const one
+//    - byHome: true to store the files in the order of their home buckets
+// Postconditions:
+//    - Like bulkLoad(const vector<File> &, bool).
+template <class Batch> size_t FileSys::loadBatch(Batch &files, bool byHome) {
+  vector<unsigned int> hashes(files.size());
+  for (size_t i = 0; i < files.size(); i++) {
+    hashes[i] = hashName(files[i].m_name);
   }
 
-  // Update the capacity and create a new table with the new capacity
-  m_currentCap = newCap;
-  m_currentTable = new File *[m_currentCap];
+  size_t slots = m_currentSize + m_oldSize + newSlots(hashes);
+  if (slots > maxLoad() * m_currentCap) {
+    // a walk holds the migration, the files take the steps of inserts
+    if (!finishMigration()) {
+      return storeBatch(files, hashes, false, true);
+    }
+    rehash(capFor(slots));
+    finishMigration();
+  }
+  size_t stored =
+      storeBatch(files, hashes, byHome && m_oldTable == nullptr, false);
+  insertStep();
+  return stored;
+}
 
-  // Initialize all elements in the new table to nullptr
-  for (int i = 0; i < m_currentCap; ++i) {
-    m_currentTable[i] = nullptr;
+// Name: insertBatch
+// Desc: Inserts a batch of files with the rehash checks of a single insert.
+// If the batch does not fit under the load limit, the rehash to a table
+// that fits it is started before the first file is stored; otherwise the
+// running migration takes one step after the batch instead of one per
+// file. When a live iterator holds the migration, the table cannot grow and
+// the files are inserted one by one, the ones the table has no room for are
+// refused like by insert. Parameters:
+//    - files: the files to be inserted
+// Postconditions:
+//    - Like an insert of every file of files, returns the number of files
+//    that were stored. The migration still ends after four batches.
+size_t FileSys::insertBatch(const vector<File> &files) {
+  vector<unsigned int> hashes(files.size());
+  for (size_t i = 0; i < files.size(); i++) {
+    hashes[i] = hashName(files[i].m_name);
   }
 
-  // Reset the current size and number of deleted elements
-  m_currentSize = 0;
-  m_currNumDeleted = 0;
-  m_transferIndex = 0;
+  // a table with a migration running can only start the next one after it
+  size_t slots = m_currentSize + m_oldSize + newSlots(hashes);
+  if (slots > maxLoad() * m_currentCap) {
+    if (!finishMigration()) {
+      return storeBatch(files, hashes, false, true);
+    }
+    rehash(capFor(slots)); // takes the first migration step
+    return storeBatch(files, hashes, true, false);
+  }
+  size_t stored = storeBatch(files, hashes, true, false);
+  insertStep();
+  return stored;
+}
 
-  // Transfer data from the old table to the new table
-  transferData();
+// Name: newSlots
+// Desc: Counts the slots a batch of new files takes at most. A GROUPSTORE
+// slot holds every file of a name, the slots needed are the distinct names.
+// Two names with the same hash are counted once, the table then grows a
+// little sooner, like after any rehash. Parameters:
+//    - hashes: the hash values of the names of the files
+size_t FileSys::newSlots(const vector<unsigned int> &hashes) const {
+  if (m_storeMode != GROUPSTORE) {
+    return hashes.size();
+  }
+  vector<unsigned int> names(hashes);
+  sort(names.begin(), names.end());
+  return unique(names.begin(), names.end()) - names.begin();
 }
 
-// Name: transferData
-// Desc: Transfers a portion of entries from the old hash table to the new hash
-// table. Parameters: None Preconditions:
-//    - The old table (m_oldTable) and the new table (m_currentTable) must be
-//    properly initialized.
-//    - m_transferIndex should be set to the correct starting index for
-//    transferring data.
+// Name: storeBatch
+// Desc: Stores the new files of a batch without the rehash checks, the
+// caller sized the table. The name index is grown once for the batch.
+// Duplicates within the batch and files already stored are skipped by the
+// lookup of isNewFile, a duplicate has the same home bucket as the file it
+// repeats, so in home order it probes cache lines that are loaded already.
+// Parameters:
+//    - files: the files to be inserted, the names of the stored ones are
+//    moved into their slots unless files is const
+//    - hashes: the hash values of the names of the files
+//    - byHome: true to store the files in the order of their home buckets
+//    - stepEach: true to take the rehash check of an insert after every
+//    stored file, for a table the caller could not size
 // Postconditions:
-//    - Transfers a quarter of the entries from the old table to the new table.
-//    - Updates the m_transferIndex to the next index to be transferred.
-//    - Decreases m_oldSize by the number of entries transferred.
-//    - If all entries have been transferred, it cleans up the old table.
-void FileSys::transferData() {
-
-  // Calculate the number of entries to transfer (1/4 of the old table's
-  // capacity)
-  int entriesToTransfer = floor(m_oldCap / 4);
-  int transferred = 0;
+//    - Returns the number of files that were stored.
+template <class Batch>
+size_t FileSys::storeBatch(Batch &files, const vector<unsigned int> &hashes,
+                           bool byHome, bool stepEach) {
+  // the name index holds every block in FILESTORE
+  size_t names = 2 * (m_namesSize + files.size() + 1);
+  if (m_storeMode == FILESTORE && names > m_namesCap) {
+    nameIndexGrow(nextPowerOfTwo(names));
+  }
 
-  // Transfer entries from the old table to the new table
-  while (transferred < entriesToTransfer && m_transferIndex < m_oldCap) {
-    transferEntry(m_transferIndex); // Transfer the entry at the current index
-    transferred++;     // Increment the count of transferred entries
-    m_transferIndex++; // Move to the next index for the next transfer
-    m_oldSize--;       // Decrease the size of the old table
+  vector<size_t> order(files.size());
+  if (byHome) {
+    homeOrder(files, hashes, order);
+  } else {
+    for (size_t i = 0; i < files.size(); i++) {
+      order[i] = i;
+    }
   }
 
-  // If all entries have been transferred, clean up the old table
-  if (m_transferIndex >= m_oldCap) {
-    cleanUpOldTable();
+  size_t stored = 0;
+  for (size_t i : order) {
+    if (!isNewFile(files[i].m_name, files[i].m_diskBlock, hashes[i]) ||
+        !addNew(files[i], hashes[i])) {
+      continue;
+    }
+    stored++;
+    if (stepEach) {
+      insertStep();
+    }
   }
+  return stored;
 }
 
-// Name: transferEntry
-// Desc: Transfers a single entry from the old hash table to the new hash table
-// based on the given transfer index. Parameters:
-//    - transferIndex: the index of the entry in the old table to be
-//    transferred.
-// Preconditions:
-//    - The old table (m_oldTable) and the new table (m_currentTable) must be
-//    properly initialized.
-//    - transferIndex must be within the bounds of the old table’s capacity
-//    (m_oldCap).
-// Postconditions:
-//    - If the entry at transferIndex is valid and used, it is transferred to
-//    the new table based on its hash value.
-//    - Updates the m_currentSize to reflect the addition in the new table.
-//    - Sets the corresponding entry in the old table to nullptr.
-void FileSys::transferEntry(int transferIndex) {
-  // Check if the transfer index is out of bounds
-  if (transferIndex >= m_oldCap) {
-    return; // Return early if the index is beyond the old table's capacity
+// Name: homeOrder
+// Desc: Orders a batch of files by their home buckets in the current table
+// with a counting sort on the top bits of the bucket. The table is split
+// into about as many ranges as there are files, at most 2^16, and files of
+// one range are left in batch order. Parameters:
+//    - files: the files of the batch
+//    - hashes: the hash values of the names of the files
+//    - order: receives the positions of the files in files, in home order
+void FileSys::homeOrder(const vector<File> &files,
+                        const vector<unsigned int> &hashes,
+                        vector<size_t> &order) const {
+  int homeBits = 0;
+  while (homeBits < 16 && (size_t(1) << homeBits) < files.size()) {
+    homeBits++;
   }
-
-  // Retrieve the file from the old table at the specified index
-  File *oldFile = m_oldTable[transferIndex];
-  // Check if the file is null or not used
-  if (oldFile == nullptr || !oldFile->getUsed()) {
-    return; // Return early if there's no file to transfer or it's not used
+  size_t ranges = size_t(1) << homeBits;
+  vector<size_t> start(ranges + 1, 0);
+  vector<unsigned int> range(files.size());
+  for (size_t i = 0; i < files.size(); i++) {
+    size_t home = homeBucket(hashes[i], files[i].m_diskBlock, 1);
+    range[i] = (unsigned int)(((__uint128_t)home << homeBits) / m_currentCap);
+    start[range[i] + 1]++;
   }
+  for (size_t r = 0; r < ranges; r++) {
+    start[r + 1] += start[r];
+  }
+  order.resize(files.size());
+  for (size_t i = 0; i < files.size(); i++) {
+    order[start[range[i]]++] = i;
+  }
+}
 
-  // Calculate the hash value for the file's name and determine the initial
-  // index in the new table
-  int hashValue = m_hash(oldFile->getName()) % m_currentCap;
-  int newIndex = hashValue;
-  int jump = 0;
+// Name: insertStep
+// Desc: The rehash check after an insert. A table over the load limit
+// starts a rehash, otherwise a running migration takes one step.
+void FileSys::insertStep() {
+  if (lambda() > maxLoad() && m_oldTable == nullptr) {
+    rehash(growCap());
+  } else if (m_oldTable != nullptr) {
+    transferData();
+  }
+}
 
-  // Use probing to find the next available spot in the new table
-  while (m_currentTable[newIndex] != nullptr &&
-         m_currentTable[newIndex]->getUsed()) {
-    newIndex =
-        getNextIndex(newIndex, hashValue, jump, m_currentCap, hashValue, 1);
-    jump++;
-    // Avoid infinite loops by breaking if jump exceeds the new table capacity
-    if (jump >= m_currentCap) {
-      return; // Return early to prevent infinite loop
+// Name: isNewFile
+// Desc: Checks whether a file may be inserted. Parameters:
+//    - name: the name of the file
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+// Postconditions:
+//    - Returns true if block is in [DISKMIN, DISKMAX] and the file is in
+//    neither table.
+bool FileSys::isNewFile(string_view name, int block,
+                        unsigned int hashVal) const {
+  if (block < DISKMIN || block > DISKMAX) {
+    return false;
+  }
+  if (m_storeMode == GROUPSTORE) {
+    const Slot *slot = findName(name, hashVal);
+    if (slot == nullptr) {
+      return true;
     }
+    const vector<int> &group = m_groups[slot->m_diskBlock];
+    return !binary_search(group.begin(), group.end(), block);
   }
 
-  // Place the file in the new table and clear the entry in the old table
-  if (newIndex >= 0 && newIndex < m_currentCap) {
-    if (m_currentTable[newIndex] != nullptr) {
-      delete m_currentTable[newIndex]; // Prevent memory leak by deleting
-                                       // existing file in new table
+  // A File object can only be inserted once, it may still live in either table
+  return findIndex(name, block, hashVal, 1) == NOINDEX &&
+         (m_oldTable == nullptr ||
+          findIndex(name, block, hashVal, 2) == NOINDEX);
+}
+
+// Name: addFile
+// Desc: Stores a new file in the current table. Parameters:
+//    - name: the name of the file, it is swapped into the slot
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+// Preconditions:
+//    - isNewFile returned true for the file.
+// Postconditions:
+//    - Returns true if the file was stored. The rehash check is left to the
+//    caller, insertStep after a single file.
+//    - Once the files of both tables fill the current table to its load
+//    limit, a running migration is finished first, so the next rehash can
+//    start. The steps end a migration before that, unless a LiveIterator
+//    held it; while the walk goes on, the file is refused and false returned.
+bool FileSys::addFile(string &name, int block, unsigned int hashVal) {
+  if (m_oldTable != nullptr &&
+      m_currentSize + m_oldSize >= (size_t)(maxLoad() * m_currentCap) &&
+      !finishMigration()) {
+    return false;
+  }
+  size_t index;
+  if (m_storeMode == GROUPSTORE) {
+    // the first block of a name gets a new group, the slot refers to it
+    int group = newGroup(block);
+    index = placeFile(name, group, hashVal);
+    if (index == NOINDEX) {
+      freeGroup(group);
+      return false;
+    }
+  } else {
+    // The file is placed in the first empty or deleted bucket of its probe
+    // sequence, name is swapped into the slot
+    index = placeFile(name, block, hashVal);
+    if (index == NOINDEX) {
+      return false; // the table has no free bucket left
     }
-    m_currentTable[newIndex] = oldFile;  // Move the file to the new table
-    m_oldTable[transferIndex] = nullptr; // Clear the old table entry
-    m_currentSize++;                     // Increment the current table size
+    nameIndexAdd(hashVal, block, index);
   }
+  fileAdded(m_currentTable[index].m_name, hashVal, block);
+  return true;
 }
 
-// Name: cleanUpOldTable
-// Desc: Deallocates and cleans up the old hash table, resetting related
-// properties to default values. Parameters: None Preconditions:
-//    - The old table (m_oldTable) should be initialized and may contain
-//    entries.
+// Name: addBlock
+// Desc: In GROUPSTORE, adds a block to the group of a name that is already
+// stored. The slot and the probe sequence of the name are not touched.
+// Parameters:
+//    - name: the name of the file
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+// Preconditions:
+//    - isNewFile returned true for the file.
 // Postconditions:
-//    - Deallocates all entries in the old table and the table itself.
-//    - Sets the old table pointer (m_oldTable) to nullptr.
-//    - Resets transfer index, capacity, probing method, size, and number of
-//    deleted entries to default values.
-void FileSys::cleanUpOldTable() {
+//    - Returns true if the block was added to the group of name, false in
+//    FILESTORE or if name has no slot yet (addFile stores it then).
+bool FileSys::addBlock(string_view name, int block, unsigned int hashVal) {
+  if (m_storeMode != GROUPSTORE) {
+    return false;
+  }
+  const Slot *slot = findName(name, hashVal);
+  if (slot == nullptr) {
+    return false;
+  }
+  vector<int> &group = m_groups[slot->m_diskBlock];
+  group.insert(lower_bound(group.begin(), group.end(), block), block);
+  fileAdded(name, hashVal, block);
+  return true;
+}
 
-  // Check if the old table is not null
+// Name: findName
+// Desc: In GROUPSTORE, finds the slot of a name in either table, the key
+// block of every slot is 0. Parameters:
+//    - name: the name of the files
+//    - hashVal: the value of m_hash for name
+// Postconditions:
+//    - Returns the slot of name, or nullptr if no file has the name.
+const Slot *FileSys::findName(string_view name, unsigned int hashVal) const {
+  size_t index = findIndex(name, 0, hashVal, 1);
+  if (index != NOINDEX) {
+    return &m_currentTable[index];
+  }
   if (m_oldTable != nullptr) {
-    // Iterate through each entry in the old table
-    for (int i = 0; i < m_oldCap; i++) {
-      // If the entry is not null, delete the entry
-      if (m_oldTable[i] != nullptr) {
-        delete m_oldTable[i];
-      }
+    index = findIndex(name, 0, hashVal, 2);
+    if (index != NOINDEX) {
+      return &m_oldTable[index];
     }
-    // Delete the array of pointers and set the old table to null
-    delete[] m_oldTable;
-    m_oldTable = nullptr;
   }
+  return nullptr;
+}
 
-  // Reset old table properties to their default values
-  m_transferIndex = 0;
-  m_oldCap = 0;
-  m_oldProbing = DEFPOLCY; // Assuming DEFPOLCY is a predefined default policy
-  m_oldSize = 0;
-  m_oldNumDeleted = 0;
+// Name: newGroup
+// Desc: Creates a group that holds one block, an unused group is reused
+// before m_groups grows. Parameters:
+//    - block: the first block of the group
+// Postconditions:
+//    - Returns the number of the group in m_groups.
+int FileSys::newGroup(int block) {
+  int group;
+  if (!m_freeGroups.empty()) {
+    group = m_freeGroups.back();
+    m_freeGroups.pop_back();
+  } else {
+    group = (int)m_groups.size();
+    m_groups.emplace_back();
+  }
+  m_groups[group].push_back(block);
+  return group;
 }
 
-// Name: remove
-// Desc: Removes the specified file from the hash table. If the file is found,
-//       it marks the file as deleted, updates the current size and deleted
-//       count, calculates the deletion factor, and triggers rehashing if the
-//       deletion factor exceeds 80%. Also, handles incremental data transfer if
-//       rehashing is in progress.
+// Name: freeGroup
+// Desc: Empties a group whose name is no longer stored and keeps its number
+// for reuse. Parameters:
+//    - group: the number of the group in m_groups
+void FileSys::freeGroup(int group) {
+  m_groups[group].clear();
+  m_freeGroups.push_back(group);
+}
+
+// Name: findAll
+// Desc: Returns every block that a file with the given name is stored under.
+// The blocks of the name are read from one run of the name index and each one
+// is confirmed at the slot the entry points to, since two names can share a
+// hash value. The probe sequence of the name, which runs through the files of
+// other names as well, is only walked for an entry whose file has moved.
 // Parameters:
-//    - file: The file object to be removed from the hash table.
-// Preconditions:
-//    - The file system must be properly initialized and have a valid hash
-//    table.
-//    - The file object must have valid attributes (name, disk block).
+//    - name: the name of the files
 // Postconditions:
-//    - If the file is found and deleted, returns true.
-//    - If the file is not found, returns false.
-//    - Updates the current size and deleted count if the file is found.
-//    - Triggers rehashing if the deletion factor exceeds 80% and no rehashing
-//    is
-//      already in progress.
-//    - Handles incremental data transfer if rehashing is in progress.
-bool FileSys::remove(File file) {
-
-  // Calculate the initial index by applying the hash function to the file name
-  int index = m_hash(file.getName()) % m_currentCap;
-  int originalIndex = index; // Store the initial index for probing
-  int jump = 0;              // Step counter for probing
-  string name = file.getName();
-  int block = file.getDiskBlock();
-
-  // Search in the current table
-  while (index >= 0 && index < m_currentCap &&
-         m_currentTable[index] != nullptr &&
-         (name != m_currentTable[index]->getName() ||
-          block != m_currentTable[index]->getDiskBlock())) {
-    // Update the index based on the probing method
-    index = getNextIndex(index, originalIndex, jump, m_currentCap,
-                         originalIndex, 1);
-    jump++;
-    if (jump >= m_currentCap) { // Avoid infinite loop
-      return false; // Return false if probing exceeds table capacity
+//    - Returns the blocks in ascending order, an empty vector if no file has
+//    the name. The cost depends on the number of files with the name (and
+//    names with the same hash), not on the number of files in the tables.
+vector<int> FileSys::findAll(string_view name) const {
+  vector<int> blocks;
+  unsigned int hashVal = hashName(name);
+  if (m_storeMode == GROUPSTORE) {
+    // the group of the name is already sorted
+    const Slot *slot = findName(name, hashVal);
+    if (slot != nullptr) {
+      blocks = m_groups[slot->m_diskBlock];
     }
+    return blocks;
   }
 
-  // If file is not found in the current table, search in the old table
-  if (m_currentTable[index] == nullptr || jump >= m_currentCap) {
-    index = m_hash(file.getName()) %
-            m_oldCap; // Recalculate index for the old table
-    originalIndex = index;
-    jump = 0;
-
-    while (index >= 0 && index < m_oldCap && m_oldTable[index] != nullptr &&
-           (name != m_oldTable[index]->getName() ||
-            block != m_oldTable[index]->getDiskBlock())) {
-      index =
-          getNextIndex(index, originalIndex, jump, m_oldCap, originalIndex, 2);
-      jump++;
-      if (jump >= m_oldCap) { // Avoid infinite loop
-        return false; // Return false if probing exceeds old table capacity
-      }
-    }
-
-    // If file is not found in the old table, return false
-    if (m_oldTable[index] == nullptr || jump >= m_oldCap) {
-      return false;
+  size_t pos = nameHome(hashVal);
+  while (m_names[pos].m_block != 0) {
+    const NameEntry &entry = m_names[pos];
+    if (entry.m_hash == hashVal && indexedFile(entry, name)) {
+      blocks.push_back(entry.m_block);
     }
+    pos = (pos + 1) & (m_namesCap - 1);
+  }
 
-    // Mark the file as deleted in the old table
-    m_oldTable[index]->setUsed(false);
-    m_oldSize--;
-    m_oldNumDeleted++;
+  // two names with the same hash and block have two equal index entries
+  sort(blocks.begin(), blocks.end());
+  blocks.erase(unique(blocks.begin(), blocks.end()), blocks.end());
+  return blocks;
+}
 
-  } else {
-    // Mark the file as deleted in the current table
-    m_currentTable[index]->setUsed(false);
-    m_currentSize--;
-    m_currNumDeleted++;
+// Name: indexedFile
+// Desc: Checks whether a name index entry belongs to a stored file with the
+// given name. The slot of the entry is read in both tables first. A
+// migration only updates the slot for a QUADRATIC, DOUBLEHASH or LINEAR
+// table, the policies that place a file by its name alone and never move it
+// within the table. A file of another policy that moved is found by its
+// block, which takes a few probes there. Parameters:
+//    - entry: an entry of the name index with the hash value of name
+//    - name: the name of the files
+// Postconditions:
+//    - Returns true if a file with the name and the block of entry is stored.
+bool FileSys::indexedFile(const NameEntry &entry, string_view name) const {
+  for (int table = 1; table <= 2; table++) {
+    const Slot *slots = (table == 1) ? m_currentTable : m_oldTable;
+    const unsigned char *ctrl = (table == 1) ? m_currCtrl : m_oldCtrl;
+    size_t cap = (table == 1) ? m_currentCap : m_oldCap;
+    if (slots == nullptr || entry.m_slot >= cap || (ctrl[entry.m_slot] & 0x80)) {
+      continue; // out of the table, empty or deleted
+    }
+    const Slot &slot = slots[entry.m_slot];
+    if (slot.m_hash == entry.m_hash && slot.m_diskBlock == entry.m_block &&
+        slot.m_name == name) {
+      return true;
+    }
   }
 
-  // Calculate the deletion factor
-  float deletionFactor = deletedRatio();
+  // the file moved, or another name with the same hash and block is there
+  return findIndex(name, entry.m_block, entry.m_hash, 1) != NOINDEX ||
+         (m_oldTable != nullptr &&
+          findIndex(name, entry.m_block, entry.m_hash, 2) != NOINDEX);
+}
 
-  // If the deletion factor is too high and rehashing is not already in progress
-  if (deletionFactor >= 0.8 && m_oldTable == nullptr) {
-    int numDataPoints = getNumData();
-    int newCap = findNextPrime(4 * numDataPoints); // Find a new prime capacity
-    rehash(newCap);                                // Rehash the table
+// Name: nameHome
+// Desc: Returns the home entry of a name hash in the name index. All the
+// blocks of a name have the same home, so they end up in one run.
+size_t FileSys::nameHome(unsigned int hashVal) const {
+  return mixHash(hashVal, 0) & (m_namesCap - 1);
+}
+
+// Name: nameIndexAdd
+// Desc: Adds a stored file to the name index. The index doubles once it is
+// half full, it only holds 8 bytes per file so it is rebuilt at once instead
+// of incrementally. Parameters:
+//    - hashVal: the value of m_hash for the name of the file
+//    - block: the disk block number of the file
+//    - slot: the index of the slot the file is stored in
+void FileSys::nameIndexAdd(unsigned int hashVal, int block, size_t slot) {
+  if (2 * (m_namesSize + 1) > m_namesCap) {
+    nameIndexGrow(2 * m_namesCap);
   }
 
-  // If rehashing is in progress, continue transferring data
-  if (m_oldTable != nullptr) {
-    transferData();
+  size_t pos = nameHome(hashVal);
+  while (m_names[pos].m_block != 0) {
+    pos = (pos + 1) & (m_namesCap - 1);
   }
+  m_names[pos].m_hash = hashVal;
+  m_names[pos].m_block = block;
+  m_names[pos].m_slot = (unsigned int)slot;
+  m_namesSize++;
+}
 
+// Name: nameIndexMove
+// Desc: Points the name index entry of a file at the slot a migration moved
+// it to. Parameters:
+//    - hashVal: the value of m_hash for the name of the file
+//    - block: the disk block number of the file
+//    - slot: the index of the slot in the current table
+// Preconditions:
+//    - The file was added to the index. Two names with the same hash and
+//    block share one entry value, either of their entries may be updated.
+void FileSys::nameIndexMove(unsigned int hashVal, int block, size_t slot) {
+  size_t pos = nameHome(hashVal);
+  while (m_names[pos].m_block != 0) {
+    if (m_names[pos].m_hash == hashVal && m_names[pos].m_block == block) {
+      m_names[pos].m_slot = (unsigned int)slot;
+      return;
+    }
+    pos = (pos + 1) & (m_namesCap - 1);
+  }
+}
+
+// Name: nameIndexGrow
+// Desc: Rebuilds the name index with a larger capacity. Parameters:
+//    - cap: the new capacity, a power of two above m_namesCap
+void FileSys::nameIndexGrow(size_t cap) {
+  NameEntry *oldNames = m_names;
+  size_t oldCap = m_namesCap;
+  m_namesCap = cap;
+  m_names = new NameEntry[m_namesCap];
+  for (size_t i = 0; i < oldCap; i++) {
+    if (oldNames[i].m_block != 0) {
+      size_t pos = nameHome(oldNames[i].m_hash);
+      while (m_names[pos].m_block != 0) {
+        pos = (pos + 1) & (m_namesCap - 1);
+      }
+      m_names[pos] = oldNames[i];
+    }
+  }
+  delete[] oldNames;
+}
+
+// Name: nameIndexRemove
+// Desc: Removes a file from the name index with backward-shift deletion, the
+// following entries of the run move back so no deleted entry is left behind.
+// Parameters:
+//    - hashVal: the value of m_hash for the name of the file
+//    - block: the disk block number of the file
+// Preconditions:
+//    - The file was added to the index. Two names with the same hash and
+//    block share one entry value, either of their entries may be removed.
+void FileSys::nameIndexRemove(unsigned int hashVal, int block) {
+  size_t mask = m_namesCap - 1;
+  size_t pos = nameHome(hashVal);
+  while (m_names[pos].m_block != 0 && (m_names[pos].m_hash != hashVal ||
+                                       m_names[pos].m_block != block)) {
+    pos = (pos + 1) & mask;
+  }
+  if (m_names[pos].m_block == 0) {
+    return;
+  }
+
+  // an entry may fill the hole if its home is not between the hole and it
+  size_t hole = pos;
+  size_t next = (hole + 1) & mask;
+  while (m_names[next].m_block != 0) {
+    size_t home = nameHome(m_names[next].m_hash);
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      m_names[hole] = m_names[next];
+      hole = next;
+    }
+    next = (next + 1) & mask;
+  }
+  m_names[hole] = NameEntry();
+  m_namesSize--;
+}
+
+// Name: hashName
+// Desc: Hashes a file name with the hash function the table was built with.
+// Parameters:
+//    - name: the name of the file
+// Postconditions:
+//    - Returns the hash value of name, only a hash_fn needs a copy of name.
+unsigned int FileSys::hashName(string_view name) const {
+  if (m_viewHash != nullptr) {
+    return m_viewHash(name);
+  }
+  return m_hash(string(name));
+}
+
+// Name: findIndex
+// Desc: Looks for a live file with the given name and disk block in one of the
+// tables by following the probe sequence of that table. Parameters:
+//    - name: the name of the file (the key)
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+//    - table: 1 for the current table, 2 for the old table
+// Preconditions:
+//    - The requested table must be allocated.
+// Postconditions:
+//    - Returns the index of the matching slot, or NOINDEX if the file is not
+//    in the table. At most cap buckets are probed.
+size_t FileSys::findIndex(string_view name, int block, unsigned int hashVal,
+                          int table) const {
+  const Slot *slots = (table == 1) ? m_currentTable : m_oldTable;
+  size_t cap = (table == 1) ? m_currentCap : m_oldCap;
+  prob_t probing = (table == 1) ? m_currProbing : m_oldProbing;
+  if (slots == nullptr || cap == 0) {
+    return NOINDEX;
+  }
+
+  switch (probing) {
+  case SWISS:
+    return swissFindIndex(name, block, hashVal, table);
+  case ROBINHOOD:
+    return robinHoodFindIndex(name, block, hashVal, table);
+  case CUCKOO:
+    return cuckooFindIndex(name, block, hashVal, table);
+  case HOPSCOTCH:
+    return hopscotchFindIndex(name, block, hashVal, table);
+  case QUADRATIC:
+    return probeFindIndex<QUADRATIC>(name, block, hashVal, table);
+  case DOUBLEHASH:
+    return probeFindIndex<DOUBLEHASH>(name, block, hashVal, table);
+  default:
+    return probeFindIndex<LINEAR>(name, block, hashVal, table);
+  }
+}
+
+// Name: probeFindIndex
+// Desc: Lookup for the open addressing policies, instantiated once per policy
+// so the probe step is inlined into the loop. Parameters:
+//    - name: the name of the file
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+//    - table: 1 for the current table, 2 for the old table
+// Preconditions:
+//    - The table is allocated and uses the probing policy Policy.
+// Postconditions:
+//    - Returns the index of the matching slot, or NOINDEX if the file is not
+//    in the table. At most cap buckets are probed.
+template <prob_t Policy>
+size_t FileSys::probeFindIndex(string_view name, int block,
+                               unsigned int hashVal, int table) const {
+  const Slot *slots = (table == 1) ? m_currentTable : m_oldTable;
+  const unsigned char *ctrl = (table == 1) ? m_currCtrl : m_oldCtrl;
+  size_t cap = (table == 1) ? m_currentCap : m_oldCap;
+
+  // Only a slot whose control byte carries the same tag can hold the file
+  unsigned char tag = mixHash(hashVal, block) >> 25;
+  size_t index = homeIndex(hashVal, table);
+  size_t originalIndex = index;
+  size_t jump = 0;
+
+  // An empty bucket ends the probe sequence, deleted buckets are skipped
+  for (size_t probes = 0; probes < cap && ctrl[index] != CTRL_EMPTY;
+       probes++) {
+    if (ctrl[index] == tag) {
+      // the cached hash rejects a different name before comparing strings
+      const Slot &slot = slots[index];
+      if (keyBlock(slot) == block && slot.m_hash == hashVal &&
+          sameName(slot.m_name, name)) {
+        return index;
+      }
+    }
+    jump++;
+    index = nextProbe<Policy>(index, jump, cap, originalIndex);
+  }
+
+  return NOINDEX;
+}
+
+// Name: findFreeIndex
+// Desc: Finds the bucket in the current table where a file with the given
+// hash value would be inserted. Parameters:
+//    - hashVal: the value of m_hash for the name of the file
+//    - block: the disk block number of the file
+// Preconditions:
+//    - The current table must be allocated.
+// Postconditions:
+//    - Returns the index of the first empty or deleted bucket in the probe
+//    sequence of name, or NOINDEX if no such bucket is reachable.
+size_t FileSys::findFreeIndex(unsigned int hashVal, int block) const {
+  switch (m_currProbing) {
+  case SWISS:
+    return swissFreeIndex(mixHash(hashVal, block & m_keyMask));
+  case QUADRATIC:
+    return probeFreeIndex<QUADRATIC>(hashVal);
+  case DOUBLEHASH:
+    return probeFreeIndex<DOUBLEHASH>(hashVal);
+  default:
+    return probeFreeIndex<LINEAR>(hashVal);
+  }
+}
+
+// Name: homeBucket
+// Desc: Returns the bucket of a table where the probe sequence of a file
+// starts, a lookup reads it first and an insert looks for a free bucket from
+// there. Parameters:
+//    - hashVal: the value of m_hash for the name of the file
+//    - block: the disk block number of the file
+//    - table: 1 for the current table, 2 for the old table
+// Postconditions:
+//    - Returns an index of the table, for CUCKOO the first slot of the first
+//    bucket of the file.
+size_t FileSys::homeBucket(unsigned int hashVal, int block, int table) const {
+  switch ((table == 1) ? m_currProbing : m_oldProbing) {
+  case QUADRATIC:
+  case DOUBLEHASH:
+  case LINEAR:
+    return homeIndex(hashVal, table);
+  case CUCKOO: {
+    size_t first, second;
+    cuckooBuckets(hashVal, block & m_keyMask,
+                  (table == 1) ? m_currentCap : m_oldCap, first, second);
+    return first * CUCKOOWAYS;
+  }
+  default:
+    return homeIndex(mixHash(hashVal, block & m_keyMask), table);
+  }
+}
+
+// Name: prefetchHome
+// Desc: Asks the CPU to load the control byte and the slot of the home
+// bucket of a file, in the old table too while there is one. The loads run
+// in the background, so several lookups wait for memory at the same time.
+// Parameters:
+//    - hashVal: the value of m_hash for the name of the file
+//    - block: the disk block number of the file
+void FileSys::prefetchHome(unsigned int hashVal, int block) const {
+  size_t index = homeBucket(hashVal, block, 1);
+  __builtin_prefetch(m_currCtrl + index);
+  __builtin_prefetch(m_currentTable + index);
+  if (m_oldTable != nullptr) {
+    index = homeBucket(hashVal, block, 2);
+    __builtin_prefetch(m_oldCtrl + index);
+    __builtin_prefetch(m_oldTable + index);
+  }
+}
+
+// Name: probeFreeIndex
+// Desc: Insert slot search for the open addressing policies, instantiated
+// once per policy like probeFindIndex. Parameters:
+//    - hashVal: the value of m_hash for the name of the file
+// Preconditions:
+//    - The current table is allocated and uses the probing policy Policy.
+// Postconditions:
+//    - Returns the index of the first empty or deleted bucket in the probe
+//    sequence, or NOINDEX if no such bucket is reachable.
+template <prob_t Policy>
+size_t FileSys::probeFreeIndex(unsigned int hashVal) const {
+  size_t index = homeIndex(hashVal, 1);
+  size_t originalIndex = index;
+  size_t jump = 0;
+
+  // Lazy deletion: a deleted bucket is treated as empty when inserting
+  for (size_t probes = 0; probes < m_currentCap; probes++) {
+    if (m_currCtrl[index] == CTRL_EMPTY || m_currCtrl[index] == CTRL_DELETED) {
+      return index;
+    }
+    jump++;
+    index = nextProbe<Policy>(index, jump, m_currentCap, originalIndex);
+  }
+
+  return NOINDEX;
+}
+
+// Name: storeFile
+// Desc: Places a file in the first free bucket of its probe sequence in the
+// current table and updates the counters of the table. Parameters:
+//    - name: the name of the file, it is swapped into the slot so the caller's
+//    string is left with the previous content of the slot
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+// Preconditions:
+//    - The file is not already stored in the current table.
+// Postconditions:
+//    - Returns the index of the slot, or NOINDEX if the table has no free bucket.
+size_t FileSys::storeFile(string &name, int block, unsigned int hashVal) {
+  if (m_currProbing == ROBINHOOD) {
+    return robinHoodStore(name, block, hashVal);
+  }
+  if (m_currProbing == CUCKOO) {
+    return cuckooStore(name, block, hashVal);
+  }
+  if (m_currProbing == HOPSCOTCH) {
+    return hopscotchStore(name, block, hashVal);
+  }
+
+  size_t index = findFreeIndex(hashVal, block);
+  if (index == NOINDEX) {
+    return NOINDEX;
+  }
+
+  if (m_currCtrl[index] == CTRL_DELETED) {
+    m_currNumDeleted--; // a lazy deleted bucket is reused
+  }
+  fillSlot(index, name, block, hashVal);
+  m_currentSize++;
+  return index;
+}
+
+// Name: placeFile
+// Desc: Stores a new file in the current table. A CUCKOO table that runs into
+// a displacement cycle, or a HOPSCOTCH table that cannot free a slot in the
+// neighborhood, falls back to the incremental rehash, the file then goes into
+// the new table. Parameters:
+//    - name: the name of the file, it is swapped into the slot
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+// Preconditions:
+//    - The file is not stored in either table.
+// Postconditions:
+//    - Returns the index of the slot in the current table, or NOINDEX if the file
+//    could not be stored.
+size_t FileSys::placeFile(string &name, int block, unsigned int hashVal) {
+  size_t index = storeFile(name, block, hashVal);
+  if (index == NOINDEX && (m_currProbing == CUCKOO || m_currProbing == HOPSCOTCH) &&
+      growTable()) {
+    index = storeFile(name, block, hashVal);
+  }
+  return index;
+}
+
+// Name: fillSlot
+// Desc: Writes a file into a slot of the current table and sets the control
+// byte to the tag of the file, the counters are left to the caller.
+// Parameters:
+//    - index: the slot index
+//    - name: the name of the file, it is swapped into the slot
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+void FileSys::fillSlot(size_t index, string &name, int block,
+                       unsigned int hashVal) {
+  Slot &slot = m_currentTable[index];
+  slot.m_name.swap(name);
+  slot.m_diskBlock = block;
+  slot.m_hash = hashVal;
+  setCtrl(index, mixHash(hashVal, block & m_keyMask) >> 25, 1);
+}
+
+// Name: probeDistance
+// Desc: Returns how far a live slot is from the home bucket of its file, the
+// home bucket is recomputed from the cached hash. Parameters:
+//    - index: the index of a live slot
+//    - table: 1 for the current table, 2 for the old table
+// Postconditions:
+//    - Returns the number of linear probe steps from the home bucket.
+size_t FileSys::probeDistance(size_t index, int table) const {
+  const Slot &slot = (table == 1) ? m_currentTable[index] : m_oldTable[index];
+  size_t cap = (table == 1) ? m_currentCap : m_oldCap;
+  size_t home = homeIndex(mixHash(slot.m_hash, keyBlock(slot)), table);
+  return (index >= home) ? index - home : index + cap - home;
+}
+
+// Name: robinHoodFindIndex
+// Desc: Lookup for the ROBINHOOD policy. The files of a run are ordered by
+// their distance from home, so the search stops as soon as it reaches a file
+// that is closer to its home than the searched file would be. Parameters:
+//    - name: the name of the file (the key)
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+//    - table: 1 for the current table, 2 for the old table
+// Preconditions:
+//    - The requested table must be allocated and use the ROBINHOOD policy.
+// Postconditions:
+//    - Returns the index of the matching slot, or NOINDEX if the file is not in the
+//    table.
+size_t FileSys::robinHoodFindIndex(string_view name, int block,
+                                unsigned int hashVal, int table) const {
+  const Slot *slots = (table == 1) ? m_currentTable : m_oldTable;
+  const unsigned char *ctrl = (table == 1) ? m_currCtrl : m_oldCtrl;
+  size_t cap = (table == 1) ? m_currentCap : m_oldCap;
+  unsigned int mixed = mixHash(hashVal, block);
+  unsigned char tag = mixed >> 25;
+  size_t index = homeIndex(mixed, table);
+
+  for (size_t dist = 0; dist < cap && ctrl[index] != CTRL_EMPTY; dist++) {
+    // only an old table under migration has deleted buckets, they keep the
+    // position of the files after them and are skipped
+    if (ctrl[index] != CTRL_DELETED) {
+      const Slot &slot = slots[index];
+      if (ctrl[index] == tag && keyBlock(slot) == block &&
+          slot.m_hash == hashVal && sameName(slot.m_name, name)) {
+        return index;
+      }
+      if (probeDistance(index, table) < dist) {
+        return NOINDEX; // the file would have displaced this one
+      }
+    }
+    index = (index + 1 == cap) ? 0 : index + 1;
+  }
+
+  return NOINDEX;
+}
+
+// Name: robinHoodStore
+// Desc: Insert for the ROBINHOOD policy. The file walks its linear probe
+// sequence and takes the bucket of the first file that is closer to its home,
+// that file then continues the walk, until an empty bucket is reached.
+// Parameters:
+//    - name: the name of the file, it is swapped into the slot
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+// Preconditions:
+//    - The current table uses the ROBINHOOD policy and has an empty bucket.
+// Postconditions:
+//    - Returns the index where the new file was stored, or NOINDEX if the table has
+//    no empty bucket.
+size_t FileSys::robinHoodStore(string &name, int block, unsigned int hashVal) {
+  if (m_currentSize + m_currNumDeleted >= m_currentCap) {
+    return NOINDEX; // a displaced file would have nowhere to go
+  }
+
+  unsigned int mixed = mixHash(hashVal, block & m_keyMask);
+  size_t index = homeIndex(mixed, 1);
+  size_t dist = 0;
+  size_t stored = NOINDEX;
+
+  // the entry that is looking for a bucket
+  string carryName;
+  carryName.swap(name);
+  int carryBlock = block;
+  unsigned int carryHash = hashVal;
+  unsigned char carryTag = mixed >> 25;
+
+  // every bucket is visited at most once before an empty one is reached
+  for (size_t steps = 0; steps < m_currentCap; steps++) {
+    Slot &slot = m_currentTable[index];
+    bool empty = (m_currCtrl[index] & 0x80) != 0;
+    if (empty || probeDistance(index, 1) < dist) {
+      // the carried entry takes this bucket, the previous owner moves on
+      unsigned char ownerTag = m_currCtrl[index];
+      size_t ownerDist = empty ? 0 : probeDistance(index, 1);
+      slot.m_name.swap(carryName);
+      swap(slot.m_diskBlock, carryBlock);
+      swap(slot.m_hash, carryHash);
+      setCtrl(index, carryTag, 1);
+      if (stored == NOINDEX) {
+        stored = index;
+        m_currentSize++;
+      }
+      if (empty) {
+        if (ownerTag == CTRL_DELETED) {
+          m_currNumDeleted--;
+        }
+        return stored;
+      }
+      carryTag = ownerTag;
+      dist = ownerDist;
+    }
+    index = (index + 1 == m_currentCap) ? 0 : index + 1;
+    dist++;
+  }
+
+  return stored;
+}
+
+// Name: robinHoodErase
+// Desc: Backward shift delete for the ROBINHOOD policy. The files after the
+// deleted one move back by one bucket until a file sits in its home bucket or
+// a bucket is empty, so the table never holds deleted buckets. Parameters:
+//    - index: the index of the live slot to delete in the current table
+// Postconditions:
+//    - The file is removed and the table keeps the Robin Hood ordering.
+void FileSys::robinHoodErase(size_t index) {
+  size_t next = (index + 1 == m_currentCap) ? 0 : index + 1;
+
+  while ((m_currCtrl[next] & 0x80) == 0 && probeDistance(next, 1) > 0) {
+    Slot &slot = m_currentTable[index];
+    Slot &nextSlot = m_currentTable[next];
+    slot.m_name.swap(nextSlot.m_name);
+    slot.m_diskBlock = nextSlot.m_diskBlock;
+    slot.m_hash = nextSlot.m_hash;
+    setCtrl(index, m_currCtrl[next], 1);
+    index = next;
+    next = (next + 1 == m_currentCap) ? 0 : next + 1;
+  }
+
+  m_currentTable[index].m_name.clear();
+  setCtrl(index, CTRL_EMPTY, 1);
+}
+
+// Name: eraseSlot
+// Desc: Deletes the file stored in a bucket and updates the counters of the
+// table. Parameters:
+//    - index: the index of a live slot
+//    - table: 1 for the current table, 2 for the old table
+// Postconditions:
+//    - A ROBINHOOD current table shifts the following files back. A CUCKOO or
+//    HOPSCOTCH current table, which has no probe sequences, empties the
+//    bucket. Every
+//    other table marks the bucket as deleted (lazy delete). The old table
+//    always uses lazy delete, a shift could move a file behind m_transferIndex.
+void FileSys::eraseSlot(size_t index, int table) {
+  if (table == 1) {
+    m_currentSize--;
+    if (m_currProbing == ROBINHOOD) {
+      robinHoodErase(index);
+    } else if (m_currProbing == CUCKOO) {
+      m_currentTable[index].m_name.clear();
+      setCtrl(index, CTRL_EMPTY, 1);
+    } else if (m_currProbing == HOPSCOTCH) {
+      hopscotchErase(index);
+    } else {
+      setCtrl(index, CTRL_DELETED, 1);
+      m_currNumDeleted++;
+    }
+  } else {
+    setCtrl(index, CTRL_DELETED, 2);
+    m_oldSize--;
+    m_oldNumDeleted++;
+  }
+}
+
+// Name: cuckooBuckets
+// Desc: Computes the two buckets of a file in a CUCKOO table. Both hash
+// functions are derived from the user hash and the disk block, the second one
+// scrambles the user hash before it is mixed. Parameters:
+//    - hashVal: the value of m_hash for the name of the file
+//    - block: the disk block number of the file
+//    - cap: the capacity of the table
+//    - first, second: set to the two bucket numbers, they always differ
+// Postconditions:
+//    - A mixed value is mapped to a bucket by multiply and shift, which spreads
+//    the 32 bit range evenly over any bucket count without a division.
+void FileSys::cuckooBuckets(unsigned int hashVal, int block, size_t cap,
+                            size_t &first, size_t &second) {
+  size_t buckets = (cap - CUCKOOSTASH) / CUCKOOWAYS;
+  first = ((__uint128_t)mixHash(hashVal, block) * buckets) >> 32;
+  second = ((__uint128_t)mixHash(hashVal * 0xCC9E2D51u + 0x1B873593u, block) *
+            buckets) >> 32;
+  if (second == first) {
+    second = (first + 1 == buckets) ? 0 : first + 1;
+  }
+}
+
+// Name: cuckooFindIndex
+// Desc: Lookup for the CUCKOO policy. A file can only be in one of its two
+// buckets or in the stash, so a hit reads the control bytes of at most two
+// buckets and a miss also reads the CUCKOOSTASH bytes of the stash.
+// Parameters:
+//    - name: the name of the file (the key)
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+//    - table: 1 for the current table, 2 for the old table
+// Preconditions:
+//    - The requested table must be allocated and use the CUCKOO policy.
+// Postconditions:
+//    - Returns the index of the matching slot, or NOINDEX if the file is not in the
+//    table.
+size_t FileSys::cuckooFindIndex(string_view name, int block,
+                             unsigned int hashVal, int table) const {
+  const Slot *slots = (table == 1) ? m_currentTable : m_oldTable;
+  const unsigned char *ctrl = (table == 1) ? m_currCtrl : m_oldCtrl;
+  size_t cap = (table == 1) ? m_currentCap : m_oldCap;
+  unsigned char tag = mixHash(hashVal, block) >> 25;
+  size_t first, second;
+  cuckooBuckets(hashVal, block, cap, first, second);
+
+  size_t starts[3] = {first * CUCKOOWAYS, second * CUCKOOWAYS, cap - CUCKOOSTASH};
+  size_t counts[3] = {CUCKOOWAYS, CUCKOOWAYS, CUCKOOSTASH};
+  for (int part = 0; part < 3; part++) {
+    for (size_t index = starts[part]; index < starts[part] + counts[part];
+         index++) {
+      if (ctrl[index] == tag) {
+        const Slot &slot = slots[index];
+        if (keyBlock(slot) == block && slot.m_hash == hashVal &&
+            sameName(slot.m_name, name)) {
+          return index;
+        }
+      }
+    }
+  }
+
+  return NOINDEX;
+}
+
+// Name: cuckooFreeSlot
+// Desc: Finds a free slot in a bucket or in the stash of the current table.
+// Parameters:
+//    - start: the first slot of the bucket or stash
+//    - count: the number of slots to check
+// Postconditions:
+//    - Returns the index of the first empty or deleted slot, or NOINDEX.
+size_t FileSys::cuckooFreeSlot(size_t start, size_t count) const {
+  for (size_t index = start; index < start + count; index++) {
+    if (m_currCtrl[index] & 0x80) {
+      return index;
+    }
+  }
+  return NOINDEX;
+}
+
+// Name: cuckooStore
+// Desc: Insert for the CUCKOO policy. The file goes into a free slot of one of
+// its buckets. If both are full it evicts a file, which moves on to its other
+// bucket, and so on. After CUCKOOMAXKICKS evictions the walk is treated as a
+// cycle and the file that is still homeless goes into the stash. Parameters:
+//    - name: the name of the file, it is swapped into the slot
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+// Preconditions:
+//    - The current table uses the CUCKOO policy.
+// Postconditions:
+//    - Returns the index where the new file was stored, or NOINDEX if both buckets
+//    and the stash are full. The table is not changed in that case.
+size_t FileSys::cuckooStore(string &name, int block, unsigned int hashVal) {
+  size_t first, second;
+  cuckooBuckets(hashVal, block & m_keyMask, m_currentCap, first, second);
+  size_t index = cuckooFreeSlot(first * CUCKOOWAYS, CUCKOOWAYS);
+  if (index == NOINDEX) {
+    index = cuckooFreeSlot(second * CUCKOOWAYS, CUCKOOWAYS);
+  }
+
+  // the walk ends in a free bucket slot or in the stash, so it only starts
+  // when the stash has room and no file can get lost
+  size_t stashIndex = NOINDEX;
+  if (index == NOINDEX) {
+    stashIndex = cuckooFreeSlot(m_currentCap - CUCKOOSTASH, CUCKOOSTASH);
+    if (stashIndex == NOINDEX) {
+      return NOINDEX;
+    }
+  }
+
+  // the file that is looking for a slot
+  string carryName;
+  carryName.swap(name);
+  int carryBlock = block;
+  unsigned int carryHash = hashVal;
+  bool carryingNew = true;
+  size_t stored = NOINDEX;
+  size_t bucket = first;
+
+  for (int kicks = 0; index == NOINDEX && kicks < CUCKOOMAXKICKS; kicks++) {
+    // the victim changes with every kick so two files do not swap forever
+    size_t victim = bucket * CUCKOOWAYS + kicks % CUCKOOWAYS;
+    Slot &slot = m_currentTable[victim];
+    bool evictedNew = (victim == stored);
+    if (carryingNew) {
+      stored = victim;
+    }
+    carryingNew = evictedNew;
+    slot.m_name.swap(carryName);
+    swap(slot.m_diskBlock, carryBlock);
+    swap(slot.m_hash, carryHash);
+    setCtrl(victim, mixHash(slot.m_hash, keyBlock(slot)) >> 25, 1);
+
+    // the evicted file moves on to its other bucket
+    size_t carryFirst, carrySecond;
+    cuckooBuckets(carryHash, carryBlock & m_keyMask, m_currentCap, carryFirst,
+                  carrySecond);
+    bucket = (carryFirst == bucket) ? carrySecond : carryFirst;
+    index = cuckooFreeSlot(bucket * CUCKOOWAYS, CUCKOOWAYS);
+  }
+  if (index == NOINDEX) {
+    index = stashIndex; // the walk ran into a cycle
+  }
+
+  if (m_currCtrl[index] == CTRL_DELETED) {
+    m_currNumDeleted--;
+  }
+  fillSlot(index, carryName, carryBlock, carryHash);
+  m_currentSize++;
+  return carryingNew ? index : stored;
+}
+
+// Name: growTable
+// Desc: Fallback for a CUCKOO or HOPSCOTCH table that has no slot for a file
+// below the load factor limit. It starts the incremental rehash so the file can
+// go into the new table, a running migration is finished first.
+// Parameters: None
+// Postconditions:
+//    - Returns true if a new current table was created, false if files of the
+//    old table could not be transferred or a LiveIterator walks the tables,
+//    the file is not inserted then.
+bool FileSys::growTable() {
+  // the rehash cannot finish the migration while a LiveIterator walks
+  if (m_iterators > 0) {
+    return false;
+  }
+
+  if (!finishMigration()) {
+    return false;
+  }
+
+  rehash(growCap());
+  return true;
+}
+
+// Name: allocHop
+// Desc: Allocates the neighborhood bitmaps of a table. Parameters:
+//    - cap: the capacity of the table
+//    - probing: the collision handling policy of the table
+// Postconditions:
+//    - Returns cap cleared bitmaps for a HOPSCOTCH table, nullptr otherwise.
+unsigned int *FileSys::allocHop(size_t cap, prob_t probing) {
+  if (probing != HOPSCOTCH) {
+    return nullptr;
+  }
+  return new unsigned int[cap]();
+}
+
+// Name: hopscotchFindIndex
+// Desc: Lookup for the HOPSCOTCH policy. The bitmap of the home bucket tells
+// which of the next HOPRANGE slots hold its files, only those are compared.
+// Parameters:
+//    - name: the name of the file (the key)
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+//    - table: 1 for the current table, 2 for the old table
+// Preconditions:
+//    - The requested table must be allocated and use the HOPSCOTCH policy.
+// Postconditions:
+//    - Returns the index of the matching slot, or NOINDEX if the file is not in the
+//    table.
+size_t FileSys::hopscotchFindIndex(string_view name, int block,
+                                unsigned int hashVal, int table) const {
+  const Slot *slots = (table == 1) ? m_currentTable : m_oldTable;
+  const unsigned char *ctrl = (table == 1) ? m_currCtrl : m_oldCtrl;
+  const unsigned int *hop = (table == 1) ? m_currHop : m_oldHop;
+  size_t cap = (table == 1) ? m_currentCap : m_oldCap;
+  unsigned int mixed = mixHash(hashVal, block);
+  unsigned char tag = mixed >> 25;
+  size_t home = homeIndex(mixed, table);
+
+  unsigned int hops = hop[home];
+  while (hops != 0) {
+    size_t index = home + __builtin_ctz(hops);
+    if (index >= cap) {
+      index -= cap;
+    }
+    // a deleted slot of an old table keeps its bit but never matches the tag
+    const Slot &slot = slots[index];
+    if (ctrl[index] == tag && keyBlock(slot) == block &&
+        slot.m_hash == hashVal && sameName(slot.m_name, name)) {
+      return index;
+    }
+    hops &= hops - 1;
+  }
+
+  return NOINDEX;
+}
+
+// Name: hopscotchStore
+// Desc: Insert for the HOPSCOTCH policy. The first free slot after the home
+// bucket is found by linear probing. While it is too far away, a file of an
+// earlier bucket whose neighborhood still covers the free slot moves into it,
+// which brings the free slot closer. Parameters:
+//    - name: the name of the file, it is swapped into the slot
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+// Preconditions:
+//    - The current table uses the HOPSCOTCH policy.
+// Postconditions:
+//    - Returns the index where the file was stored, or NOINDEX if no slot of the
+//    neighborhood could be freed. Files may have moved in that case, but every
+//    file is still in its neighborhood.
+size_t FileSys::hopscotchStore(string &name, int block, unsigned int hashVal) {
+  unsigned int mixed = mixHash(hashVal, block & m_keyMask);
+  size_t home = homeIndex(mixed, 1);
+  size_t free = home;
+  size_t dist = 0;
+  while (dist < m_currentCap && !(m_currCtrl[free] & 0x80)) {
+    free = (free + 1 == m_currentCap) ? 0 : free + 1;
+    dist++;
+  }
+  if (dist == m_currentCap) {
+    return NOINDEX;
+  }
+
+  while (dist >= HOPRANGE) {
+    // the bucket farthest back gives the largest step towards the home bucket
+    size_t moveFrom = NOINDEX;
+    for (int back = HOPRANGE - 1; back > 0 && moveFrom == NOINDEX; back--) {
+      size_t bucket = (free >= (size_t)back) ? free - back
+                                             : free + m_currentCap - back;
+      unsigned int hops = m_currHop[bucket];
+      if (hops == 0 || __builtin_ctz(hops) >= back) {
+        continue; // no file of this bucket sits before the free slot
+      }
+      int offset = __builtin_ctz(hops);
+      moveFrom = bucket + offset;
+      if (moveFrom >= m_currentCap) {
+        moveFrom -= m_currentCap;
+      }
+      m_currHop[bucket] &= ~(1u << offset);
+      m_currHop[bucket] |= 1u << back;
+      dist -= back - offset;
+    }
+    if (moveFrom == NOINDEX) {
+      return NOINDEX;
+    }
+
+    Slot &from = m_currentTable[moveFrom];
+    Slot &to = m_currentTable[free];
+    to.m_name.swap(from.m_name);
+    to.m_diskBlock = from.m_diskBlock;
+    to.m_hash = from.m_hash;
+    setCtrl(free, m_currCtrl[moveFrom], 1);
+    setCtrl(moveFrom, CTRL_EMPTY, 1);
+    free = moveFrom;
+  }
+
+  fillSlot(free, name, block, hashVal);
+  m_currHop[home] |= 1u << dist;
+  m_currentSize++;
+  return free;
+}
+
+// Name: hopscotchErase
+// Desc: Delete for the HOPSCOTCH policy in the current table. Lookups only
+// follow the bitmap, so the slot is emptied and its bit is cleared.
+// Parameters:
+//    - index: the index of the live slot to delete in the current table
+void FileSys::hopscotchErase(size_t index) {
+  const Slot &slot = m_currentTable[index];
+  size_t home = homeIndex(mixHash(slot.m_hash, keyBlock(slot)), 1);
+  size_t dist = (index >= home) ? index - home : index + m_currentCap - home;
+  m_currHop[home] &= ~(1u << dist);
+  m_currentTable[index].m_name.clear();
+  setCtrl(index, CTRL_EMPTY, 1);
+}
+
+// Name: swissFindIndex
+// Desc: Lookup for the SWISS policy. The probe sequence walks the control
+// bytes GROUPWIDTH at a time and only the slots whose control byte matches
+// the 7 bit tag of the file are compared with the key. Parameters:
+//    - name: the name of the file (the key)
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+//    - table: 1 for the current table, 2 for the old table
+// Preconditions:
+//    - The requested table must be allocated and use the SWISS policy.
+// Postconditions:
+//    - Returns the index of the matching slot, or NOINDEX if the file is not in the
+//    table. The search stops at the first group that has an empty byte.
+size_t FileSys::swissFindIndex(string_view name, int block,
+                            unsigned int hashVal, int table) const {
+  const Slot *slots = (table == 1) ? m_currentTable : m_oldTable;
+  const unsigned char *ctrl = (table == 1) ? m_currCtrl : m_oldCtrl;
+  size_t cap = (table == 1) ? m_currentCap : m_oldCap;
+  unsigned int mixed = mixHash(hashVal, block);
+  unsigned char tag = mixed >> 25;
+  size_t pos = homeIndex(mixed, table);
+
+  // every group is visited at most once before the sequence wraps around
+  for (size_t groups = 0; groups <= cap / GROUPWIDTH; groups++) {
+    const unsigned char *group = ctrl + pos;
+    unsigned int match = matchGroup(group, tag);
+    while (match != 0) {
+      size_t index = pos + __builtin_ctz(match);
+      if (index >= cap) {
+        index -= cap; // the byte was a mirror of the start of the table
+      }
+      const Slot &slot = slots[index];
+      if (keyBlock(slot) == block && slot.m_hash == hashVal &&
+          sameName(slot.m_name, name)) {
+        return index;
+      }
+      match &= match - 1;
+    }
+    // a file is never placed past an empty bucket of its probe sequence
+    if (matchGroup(group, CTRL_EMPTY) != 0) {
+      return NOINDEX;
+    }
+    pos += GROUPWIDTH;
+    if (pos >= cap) {
+      pos -= cap;
+    }
+  }
+
+  return NOINDEX;
+}
+
+// Name: swissFreeIndex
+// Desc: Finds the insert bucket for the SWISS policy, the first empty or
+// deleted control byte in the group sequence of the file. Parameters:
+//    - mixed: the value of mixHash for the file
+// Preconditions:
+//    - The current table must be allocated and use the SWISS policy.
+// Postconditions:
+//    - Returns the index of the free bucket, or NOINDEX if no group has one.
+size_t FileSys::swissFreeIndex(unsigned int mixed) const {
+  size_t pos = homeIndex(mixed, 1);
+
+  for (size_t groups = 0; groups <= m_currentCap / GROUPWIDTH; groups++) {
+    unsigned int match = matchFree(m_currCtrl + pos);
+    if (match != 0) {
+      size_t index = pos + __builtin_ctz(match);
+      return (index >= m_currentCap) ? index - m_currentCap : index;
+    }
+    pos += GROUPWIDTH;
+    if (pos >= m_currentCap) {
+      pos -= m_currentCap;
+    }
+  }
+
+  return NOINDEX;
+}
+
+// Name: mixHash
+// Desc: Combines the user hash of a name with the disk block of the file and
+// scrambles the bits (murmur3 finalizer), the user hash may leave the high
+// bits unused for short names. Parameters:
+//    - hashVal: the value of m_hash for the name of the file
+//    - block: the disk block number of the file
+// Postconditions:
+//    - Returns a 32 bit hash of the (name, block) pair. The top 7 bits are the
+//    control byte tag, the SWISS policy also places the file with it.
+unsigned int FileSys::mixHash(unsigned int hashVal, int block) {
+  unsigned int mixed = hashVal ^ ((unsigned int)block * 0x9E3779B1u);
+  mixed ^= mixed >> 16;
+  mixed *= 0x85EBCA6Bu;
+  mixed ^= mixed >> 13;
+  mixed *= 0xC2B2AE35u;
+  mixed ^= mixed >> 16;
+  return mixed;
+}
+
+// Name: matchGroup
+// Desc: Compares GROUPWIDTH control bytes with a value, with a single SSE2
+// compare when it is available. Parameters:
+//    - group: pointer to the first control byte of the group
+//    - value: the control byte to look for
+// Postconditions:
+//    - Returns a bit mask, bit i is set if group[i] == value.
+unsigned int FileSys::matchGroup(const unsigned char *group,
+                                 unsigned char value) {
+#ifdef __SSE2__
+  __m128i bytes = _mm_loadu_si128((const __m128i *)group);
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value)));
+#else
+  unsigned int match = 0;
+  for (int i = 0; i < GROUPWIDTH; i++) {
+    if (group[i] == value) {
+      match |= 1u << i;
+    }
+  }
+  return match;
+#endif
+}
+
+// Name: matchFree
+// Desc: Finds the empty and deleted bytes of a group. Both markers have the
+// high bit set while a tag never has it, so the sign bits are the answer.
+// Parameters:
+//    - group: pointer to the first control byte of the group
+// Postconditions:
+//    - Returns a bit mask, bit i is set if group[i] is empty or deleted.
+unsigned int FileSys::matchFree(const unsigned char *group) {
+#ifdef __SSE2__
+  return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#else
+  unsigned int match = 0;
+  for (int i = 0; i < GROUPWIDTH; i++) {
+    if (group[i] & 0x80) {
+      match |= 1u << i;
+    }
+  }
+  return match;
+#endif
+}
+
+// Name: nextLive
+// Desc: Finds the next live slot of a table, a group of empty and deleted
+// slots is passed with a single matchFree. Parameters:
+//    - ctrl: the control bytes of the table, with the mirrored group
+//    - index: the slot the search starts at
+//    - cap: the capacity of the table
+// Postconditions:
+//    - Returns the first live slot from index on, or cap if there is none.
+size_t FileSys::nextLive(const unsigned char *ctrl, size_t index, size_t cap) {
+  while (index < cap) {
+    unsigned int live = ~matchFree(ctrl + index) & 0xFFFF;
+    if (live != 0) {
+      // a bit past the end belongs to a mirrored byte of the first group
+      index += __builtin_ctz(live);
+      return (index < cap) ? index : cap;
+    }
+    index += GROUPWIDTH;
+  }
+  return cap;
+}
+
+// Name: allocCtrl
+// Desc: Allocates the control bytes of a table with cap slots. Parameters:
+//    - cap: the capacity of the table
+// Postconditions:
+//    - Returns cap + GROUPWIDTH bytes set to CTRL_EMPTY. The extra bytes
+//    mirror the first GROUPWIDTH bytes so a group can be loaded at any index.
+unsigned char *FileSys::allocCtrl(size_t cap) {
+  unsigned char *ctrl = new unsigned char[cap + GROUPWIDTH];
+  memset(ctrl, CTRL_EMPTY, cap + GROUPWIDTH);
+  return ctrl;
+}
+
+// Name: setCtrl
+// Desc: Writes the control byte of a slot and keeps the mirrored copy at the
+// end of the array in sync. Parameters:
+//    - index: the slot index
+//    - value: CTRL_EMPTY, CTRL_DELETED or the tag of a live file
+//    - table: 1 for the current table, 2 for the old table
+// Postconditions:
+//    - The control byte of the slot is set to value.
+void FileSys::setCtrl(size_t index, unsigned char value, int table) {
+  unsigned char *ctrl = (table == 1) ? m_currCtrl : m_oldCtrl;
+  size_t cap = (table == 1) ? m_currentCap : m_oldCap;
+  ctrl[index] = value;
+  if (index < GROUPWIDTH) {
+    ctrl[cap + index] = value;
+  }
+}
+
+// Name: getNumData
+// Desc: Returns the number of current data points in the hash table. insert
+// and remove keep m_currentSize at the number of live entries (remove moves an
+// entry from m_currentSize to m_currNumDeleted), so deleted entries must not
+// be subtracted a second time. Parameters: None Preconditions:
+//    - The hash table must be properly initialized and have a valid
+//    m_currentSize and m_currNumDeleted.
+// Postconditions:
+//    - Returns the count of live data points (excluding deleted entries) in the
+//    hash table.
+size_t FileSys::getNumData() const { return m_currentSize; }
+
+// Name: maxLoad
+// Desc: Returns the load factor limit of the current table. A HOPSCOTCH lookup
+// only reads the neighborhood of the home bucket, so its table stays fast at a
+// higher load than a table with probe sequences. Parameters: None
+// Postconditions:
+//    - Returns HOPMAXLOAD for a HOPSCOTCH table, MAXLOAD otherwise.
+float FileSys::maxLoad() const {
+  return (m_currProbing == HOPSCOTCH) ? HOPMAXLOAD : MAXLOAD;
+}
+
+// Name: growCap
+// Desc: Returns the capacity of the table a rehash creates, the smallest prime
+// capacity greater than 4 times the live data. A new HOPSCOTCH table is sized to
+// 2 times the live data, it may be filled up to HOPMAXLOAD. A POW2CAP table
+// uses the next power of two instead of the next prime. Parameters: None
+// Postconditions:
+//    - Returns a prime (or power of two) capacity of at least MINPRIME and its
+//    fast modulus constant, the constant of a power of two is not used.
+TableCap FileSys::growCap() { return capFor(getNumData()); }
+
+// Name: capFor
+// Desc: Returns the capacity of a new table for a number of live entries, by
+// the rule of growCap. Parameters:
+//    - live: the number of slots the new table starts out with
+// Postconditions:
+//    - Returns a prime (or power of two) capacity of at least MINPRIME and its
+//    fast modulus constant.
+TableCap FileSys::capFor(size_t live) const {
+  size_t factor = (m_newPolicy == HOPSCOTCH) ? 2 : 4;
+  if (m_capMode == POW2CAP) {
+    TableCap pow2;
+    pow2.m_cap = nextPowerOfTwo(factor * live);
+    return pow2;
+  }
+  return primeCapAtLeast(factor * live + 1);
+}
+
+// Name: fitCap
+// Desc: Returns the smallest capacity a new table can hold a number of live
+// entries in without going over the load limit of its policy. Parameters:
+//    - live: the number of slots the table has to hold
+// Postconditions:
+//    - Returns a prime (or power of two) capacity of at least MINPRIME and its
+//    fast modulus constant.
+TableCap FileSys::fitCap(size_t live) const {
+  float limit = (m_newPolicy == HOPSCOTCH) ? HOPMAXLOAD : MAXLOAD;
+  size_t cap = (size_t)ceil(live / limit);
+  if (m_capMode == POW2CAP) {
+    TableCap pow2;
+    pow2.m_cap = nextPowerOfTwo(cap);
+    return pow2;
+  }
+  return primeCapAtLeast(cap);
+}
+
+// Name: finishMigration
+// Desc: Transfers every file left in the old table in one go instead of a
+// step per operation, the budget of setMigrationStep does not apply.
+// Parameters: None
+// Postconditions:
+//    - Returns true if there is no old table anymore, false if files of the
+//    old table could not be transferred or a LiveIterator walks the tables.
+bool FileSys::finishMigration() {
+  // a whole step scans the rest of the old table, the next ones start over
+  // for the files the new table had no room for
+  for (int step = 0; step <= 4 && m_oldTable != nullptr; step++) {
+    transferData(true);
+  }
+  return m_oldTable == nullptr;
+}
+
+// Name: rehash
+// Desc: Rehashes the hash table to a new capacity, transferring all live data
+// nodes from the current table to the new table incrementally. Parameters:
+//    - newCap: the new capacity for the hash table and its fast modulus
+//    constant, which should be the smallest prime capacity greater than
+//    ((m_currentSize - m_currNumDeleted) * 4).
+// Preconditions:
+//    - The hash table must be properly initialized and have a current capacity
+//    m_currentCap.
+//    - newCap should be a valid prime number greater than the current capacity
+//    adjusted for live data points.
+// Postconditions:
+//    - Initiates the rehashing process, creating a new table with the specified
+//    capacity.
+//    - Starts transferring live data from the current table to the new table
+//    incrementally.
+//    - Updates the current table to the new table once the transfer is complete
+//    and deallocates the old table's memory.
+void FileSys::rehash(TableCap newCap) {
+
+  // Save the current table and its properties to old variables
+  m_oldTable = m_currentTable;
+  m_oldCtrl = m_currCtrl;
+  m_oldHop = m_currHop;
+  m_oldMagic = m_currMagic;
+  m_oldCap = m_currentCap;
+  m_oldProbing = m_currProbing;
+  m_oldSize = m_currentSize;
+  m_oldNumDeleted = m_currNumDeleted;
+
+  // If the current probing method is different from the new policy, update it
+  if (m_currProbing != m_newPolicy) {
+    m_currProbing = m_newPolicy;
+  }
+
+  // Update the capacity and create a new table with the new capacity, all
+  // of its slots start out empty
+  m_currentCap = newCap.m_cap;
+  m_currMagic = newCap.m_magic;
+  m_currentTable = new Slot[m_currentCap];
+  m_currCtrl = allocCtrl(m_currentCap);
+  m_currHop = allocHop(m_currentCap, m_currProbing);
+
+  // Reset the current size and number of deleted elements
+  m_currentSize = 0;
+  m_currNumDeleted = 0;
+  m_transferIndex = 0;
+
+  // Transfer data from the old table to the new table
+  transferData();
+}
+
+// Name: transferData
+// Desc: Transfers a portion of entries from the old hash table to the new hash
+// table. Parameters:
+//    - whole: true to scan the rest of the old table whatever the budget
+// Preconditions:
+//    - The old table (m_oldTable) and the new table (m_currentTable) must be
+//    properly initialized.
+//    - m_transferIndex should be set to the correct starting index for
+//    transferring data.
+// Postconditions:
+//    - Scans a quarter of the old table, or the budget of setMigrationStep,
+//    but never less than minTransfer slots, and moves the files it finds.
+//    - Updates the m_transferIndex to the next index to be transferred.
+//    - Decreases m_oldSize by the number of entries transferred.
+//    - If all entries have been transferred, it cleans up the old table.
+//    - Does nothing while a LiveIterator walks the tables.
+void FileSys::transferData(bool whole) {
+  // a LiveIterator is walking the tables, the files stay where they are
+  if (m_iterators > 0) {
+    return;
+  }
+
+  // Calculate the number of entries to transfer (1/4 of the old table's
+  // capacity by default), a step never scans less than minTransfer slots
+  size_t entriesToTransfer = m_oldCap / 4;
+  size_t movesAllowed = m_oldCap;
+  bool timed = !whole && m_stepMode == TIMESTEP;
+  if (whole) {
+    entriesToTransfer = m_oldCap;
+  } else if (m_stepMode == SLOTSTEP) {
+    entriesToTransfer = m_stepAmount;
+  } else if (m_stepMode != QUARTERSTEP) {
+    entriesToTransfer = m_oldCap; // the step ends on moves or time
+    if (m_stepMode == MOVESTEP) {
+      movesAllowed = m_stepAmount;
+    }
+  }
+  size_t mustTransfer = minTransfer();
+  size_t transferred = 0;
+  size_t moved = 0;
+  chrono::steady_clock::time_point start;
+  if (timed) {
+    start = chrono::steady_clock::now();
+  }
+
+  // Transfer entries from the old table to the new table
+  while (m_transferIndex < m_oldCap &&
+         (transferred < mustTransfer ||
+          (transferred < entriesToTransfer && moved < movesAllowed))) {
+    // Transfer the entry at the current index
+    if (transferEntry(m_transferIndex)) {
+      m_oldSize--; // Decrease the size of the old table
+      moved++;
+    }
+    transferred++;     // Increment the count of transferred entries
+    m_transferIndex++; // Move to the next index for the next transfer
+
+    // the clock is read every TIMECHECK slots, a read costs about as much
+    // as scanning a few slots
+    if (timed && transferred % TIMECHECK == 0 &&
+        chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - start)
+                .count() >= (long long)m_stepAmount) {
+      entriesToTransfer = transferred;
+    }
+  }
+
+  // If all entries have been transferred, clean up the old table. A file the
+  // new table had no room for is still live, the scan starts over for it.
+  if (m_transferIndex >= m_oldCap) {
+    if (m_oldSize == 0) {
+      cleanUpOldTable();
+    } else {
+      m_transferIndex = 0;
+    }
+  }
+}
+
+// Name: minTransfer
+// Desc: Returns the slots a migration step has to scan so the migration ends
+// before the current table needs a rehash of its own. The files left in the
+// old table take slots of the current table too, so the inserts the table
+// can still take are what its load limit leaves after the files of both
+// tables. Every insert takes a step, the slots left are spread over them.
+// Parameters: None
+// Postconditions:
+//    - Returns the slots left to scan divided by the inserts left before the
+//    load limit, rounded up, or every slot left if there is at most one.
+size_t FileSys::minTransfer() const {
+  size_t left = m_oldCap - min(m_transferIndex, m_oldCap);
+  size_t limit = (size_t)(maxLoad() * m_currentCap);
+  size_t stored = m_currentSize + m_oldSize;
+  size_t inserts = (limit > stored) ? limit - stored : 0;
+  if (inserts <= 1) {
+    return left;
+  }
+  return (left + inserts - 1) / inserts;
+}
+
+// Name: transferEntry
+// Desc: Transfers a single entry from the old hash table to the new hash table
+// based on the given transfer index. Parameters:
+//    - transferIndex: the index of the entry in the old table to be
+//    transferred.
+// Preconditions:
+//    - The old table (m_oldTable) and the new table (m_currentTable) must be
+//    properly initialized.
+//    - transferIndex must be within the bounds of the old table’s capacity
+//    (m_oldCap).
+// Postconditions:
+//    - If the entry at transferIndex is valid and used, it is transferred to
+//    the new table based on its hash value.
+//    - Updates the m_currentSize to reflect the addition in the new table.
+//    - Marks the corresponding entry in the old table as deleted.
+//    - Returns true if a file was moved, false if the slot held no file or
+//    the new table had no room for it.
+bool FileSys::transferEntry(size_t transferIndex) {
+  // Check if the transfer index is out of bounds
+  if (transferIndex >= m_oldCap) {
+    return false; // Return early if the index is beyond the old table's capacity
+  }
+
+  // Check if the slot is empty or deleted, a live slot has a tag
+  if (m_oldCtrl[transferIndex] & 0x80) {
+    return false; // Return early if there's no file to transfer
+  }
+  Slot &oldSlot = m_oldTable[transferIndex];
+
+  // Move the file into the new table, the name is swapped instead of copied
+  // and the cached hash places it without hashing the name again
+  size_t index = storeFile(oldSlot.m_name, oldSlot.m_diskBlock, oldSlot.m_hash);
+  if (index == NOINDEX) {
+    return false; // the file stays live in the old table
+  }
+  // findAll reads a file of a probe sequence table at the slot of its name
+  // index entry, the other policies find it by its block
+  if (m_storeMode == FILESTORE &&
+      (m_currProbing == QUADRATIC || m_currProbing == DOUBLEHASH ||
+       m_currProbing == LINEAR)) {
+    nameIndexMove(oldSlot.m_hash, oldSlot.m_diskBlock, index);
+  }
+
+  // The old bucket stays occupied as a deleted entry, emptying it would cut
+  // the probe sequences of files that have not been transferred yet
+  setCtrl(transferIndex, CTRL_DELETED, 2);
+  return true;
+}
+
+// Name: cleanUpOldTable
+// Desc: Deallocates and cleans up the old hash table, resetting related
+// properties to default values. Parameters: None Preconditions:
+//    - The old table (m_oldTable) should be initialized and may contain
+//    entries.
+// Postconditions:
+//    - Deallocates all entries in the old table and the table itself.
+//    - Sets the old table pointer (m_oldTable) to nullptr.
+//    - Resets transfer index, capacity, probing method, size, and number of
+//    deleted entries to default values.
+void FileSys::cleanUpOldTable() {
+
+  // The files are stored inside the slots, so deleting the slot array
+  // releases the whole old table at once
+  delete[] m_oldTable;
+  delete[] m_oldCtrl;
+  delete[] m_oldHop;
+  m_oldTable = nullptr;
+  m_oldCtrl = nullptr;
+  m_oldHop = nullptr;
+
+  // Reset old table properties to their default values
+  m_transferIndex = 0;
+  m_oldMagic = 0;
+  m_oldCap = 0;
+  m_oldProbing = DEFPOLCY; // Assuming DEFPOLCY is a predefined default policy
+  m_oldSize = 0;
+  m_oldNumDeleted = 0;
+}
+
+// Name: remove
+// Desc: Removes the specified file from the hash table. If the file is found,
+//       it marks the file as deleted, updates the current size and deleted
+//       count, calculates the deletion factor, and triggers rehashing if the
+//       deletion factor exceeds 80%. Also, handles incremental data transfer if
+//       rehashing is in progress.
+// Parameters:
+//    - file: The file object to be removed from the hash table.
+// Preconditions:
+//    - The file system must be properly initialized and have a valid hash
+//    table.
+//    - The file object must have valid attributes (name, disk block).
+// Postconditions:
+//    - If the file is found and deleted, returns true.
+//    - If the file is not found, returns false.
+//    - Updates the current size and deleted count if the file is found.
+//    - Triggers rehashing if the deletion factor exceeds 80% and no rehashing
+//    is
+//      already in progress.
+//    - Handles incremental data transfer if rehashing is in progress.
+bool FileSys::remove(const File &file) {
+  if (!removeFile(file, hashName(file.m_name))) {
+    return false;
+  }
+  removeStep();
   return true; // Return true if the file was successfully removed
 }
 
+// Name: removeBatch
+// Desc: Removes a batch of files with the rehash checks of a single remove.
+// The files are removed in the order of their home buckets, then the
+// deleted ratio is checked and the migration takes its step once.
+// Parameters:
+//    - files: the files to be removed
+// Postconditions:
+//    - Like a remove of every file of files, returns the number of files
+//    that were removed.
+size_t FileSys::removeBatch(const vector<File> &files) {
+  vector<unsigned int> hashes(files.size());
+  for (size_t i = 0; i < files.size(); i++) {
+    hashes[i] = hashName(files[i].m_name);
+  }
+  vector<size_t> order;
+  homeOrder(files, hashes, order);
+
+  size_t removed = 0;
+  for (size_t i : order) {
+    if (removeFile(files[i], hashes[i])) {
+      removed++;
+    }
+  }
+  if (removed > 0) {
+    removeStep();
+  }
+  return removed;
+}
+
+// Name: removeFile
+// Desc: Finds a file in either table and deletes it, the rehash check is
+// left to the caller. Parameters:
+//    - file: the file to be removed
+//    - hashVal: the value of m_hash for the name of the file
+// Postconditions:
+//    - Returns true if the file was found and deleted.
+bool FileSys::removeFile(const File &file, unsigned int hashVal) {
+  // Search in the current table first, the hash value is shared by both tables
+  int key = file.m_diskBlock & m_keyMask;
+  int table = 1;
+  size_t index = findIndex(file.m_name, key, hashVal, 1);
+
+  // If file is not found in the current table, search in the old table
+  if (index == NOINDEX && m_oldTable != nullptr) {
+    table = 2;
+    index = findIndex(file.m_name, key, hashVal, 2);
+  }
+
+  // If file is not found in the old table, return false
+  if (index == NOINDEX) {
+    return false;
+  }
+
+  if (m_storeMode == GROUPSTORE) {
+    // the block leaves the group, the slot of the name is deleted with the
+    // last block only
+    int group = ((table == 1) ? m_currentTable : m_oldTable)[index].m_diskBlock;
+    vector<int> &blocks = m_groups[group];
+    vector<int>::iterator it =
+        lower_bound(blocks.begin(), blocks.end(), file.m_diskBlock);
+    if (it == blocks.end() || *it != file.m_diskBlock) {
+      return false;
+    }
+    blocks.erase(it);
+    if (blocks.empty()) {
+      freeGroup(group);
+      eraseSlot(index, table);
+    }
+  } else {
+    // Mark the file as deleted in its table
+    eraseSlot(index, table);
+    nameIndexRemove(hashVal, file.m_diskBlock);
+  }
+  fileRemoved(file.m_name, hashVal, file.m_diskBlock);
+  return true;
+}
+
+// Name: removeStep
+// Desc: The rehash check after a remove. A table with too many deleted
+// buckets starts a rehash, and a running migration takes one step.
+void FileSys::removeStep() {
+  // Calculate the deletion factor
+  float deletionFactor = deletedRatio();
+
+  // If the deletion factor is too high and rehashing is not already in progress
+  if (deletionFactor >= 0.8 && m_oldTable == nullptr) {
+    rehash(growCap()); // Rehash the table into a new prime capacity
+  }
+
+  // If rehashing is in progress, continue transferring data
+  if (m_oldTable != nullptr) {
+    transferData();
+  }
+}
+
 // Name: getFile
 // Desc: Retrieves a file from the hash table that matches the given name and
 // disk block. Parameters:
@@ -559,112 +2362,771 @@ bool FileSys::remove(File file) {
 //    - Returns the File object that matches the given name and disk block if
 //    found.
 //    - If no matching file is found, empty object is returned
-const File FileSys::getFile(string name, int block) const {
-  // Calculate the initial index using the hash function
-  int index = m_hash(name) % m_currentCap;
-  int originalIndex = index;
-  int jump = 0;
+const File FileSys::getFile(const string &name, int block) const {
+  const Slot *slot = findFile(name, block);
+  if (slot != nullptr) {
+    return File(slot->m_name, block, true);
+  }
+
+  // Return an empty File object if the file is not found
+  return File();
+}
+
+// Name: findFile
+// Desc: Looks up a file without copying its name. A std::string, a string
+// literal or any other character range converts to name without allocating.
+// Parameters:
+//    - name: the name of the file to be retrieved.
+//    - block: the disk block number associated with the file.
+// Postconditions:
+//    - Returns the slot that holds the file, or nullptr if it is not in the
+//    file system. The pointer is valid until the next insert, remove or
+//    updateDiskBlock, any of which may move the file.
+const Slot *FileSys::findFile(string_view name, int block) const {
+  return findHashed(name, block, hashName(name));
+}
+
+// Name: findFiles
+// Desc: Looks up a batch of files given by their names and blocks, nothing is
+// allocated for a key. A file is hashed and its home buckets are prefetched
+// FINDAHEAD files before it is looked up, and the name stored in its home
+// slot half as many files before, so the cache misses of the next lookups
+// overlap with the current one instead of following it. Parameters:
+//    - keys: the name and block of every file to look up
+//    - count: the number of keys
+//    - found: receives the slot of every file, nullptr for a file that is
+//    not stored, it has room for count slots
+// Postconditions:
+//    - found[i] is findFile(keys[i].first, keys[i].second), returns the
+//    number of files found.
+size_t FileSys::findFiles(const FileKey *keys, size_t count,
+                          const Slot **found) const {
+  unsigned int hashes[FINDAHEAD];
+  size_t hits = 0;
+  for (size_t i = 0; i < count + FINDAHEAD; i++) {
+    // the file prefetched FINDAHEAD files ago is looked up before its hash
+    // is overwritten by the file i
+    if (i >= FINDAHEAD) {
+      size_t next = i - FINDAHEAD;
+      found[next] = findHashed(keys[next].first, keys[next].second,
+                               hashes[next % FINDAHEAD]);
+      if (found[next] != nullptr) {
+        hits++;
+      }
+    }
+    // halfway, the home slot has arrived and the name it points to follows
+    if (i >= FINDAHEAD / 2 && i - FINDAHEAD / 2 < count) {
+      size_t half = i - FINDAHEAD / 2;
+      prefetchName(hashes[half % FINDAHEAD], keys[half].second);
+    }
+    if (i < count) {
+      hashes[i % FINDAHEAD] = hashName(keys[i].first);
+      prefetchHome(hashes[i % FINDAHEAD], keys[i].second);
+    }
+  }
+  return hits;
+}
+
+// Name: findFiles
+// Desc: findFiles for a batch of File objects, their names are viewed and
+// not copied. Parameters:
+//    - files: the name and block of every file to look up
+//    - found: receives the slot of every file, nullptr for a file that is
+//    not stored
+// Postconditions:
+//    - found[i] is findFile(files[i].getName(), files[i].getDiskBlock()),
+//    returns the number of files found.
+size_t FileSys::findFiles(const vector<File> &files,
+                          vector<const Slot *> &found) const {
+  vector<FileKey> keys;
+  keys.reserve(files.size());
+  for (const File &file : files) {
+    keys.emplace_back(file.m_name, file.m_diskBlock);
+  }
+  found.assign(files.size(), nullptr);
+  return findFiles(keys.data(), keys.size(), found.data());
+}
+
+// Name: prefetchName
+// Desc: Asks the CPU to load the name stored in the home slot of a file in
+// the current table, a long name lives on the heap apart from its slot. The
+// home bucket should have been prefetched by prefetchHome before.
+// Parameters:
+//    - hashVal: the value of m_hash for the name of the file
+//    - block: the disk block number of the file
+void FileSys::prefetchName(unsigned int hashVal, int block) const {
+  size_t index = homeBucket(hashVal, block, 1);
+  if (!(m_currCtrl[index] & 0x80)) {
+    __builtin_prefetch(m_currentTable[index].m_name.data());
+  }
+}
+
+// Name: findHashed
+// Desc: findFile for a name that is hashed already. Parameters:
+//    - name: the name of the file
+//    - block: the disk block number of the file
+//    - hashVal: the value of m_hash for name
+// Postconditions:
+//    - Returns the slot that holds the file, or nullptr.
+const Slot *FileSys::findHashed(string_view name, int block,
+                                unsigned int hashVal) const {
+  if (m_storeMode == GROUPSTORE) {
+    // one probe for the name and a binary search of its blocks
+    const Slot *slot = findName(name, hashVal);
+    if (slot != nullptr &&
+        binary_search(m_groups[slot->m_diskBlock].begin(),
+                      m_groups[slot->m_diskBlock].end(), block)) {
+      return slot;
+    }
+    return nullptr;
+  }
+  size_t index = findIndex(name, block, hashVal, 1);
+  if (index != NOINDEX) {
+    return &m_currentTable[index];
+  }
+
+  // If the file is not found in the current table, check the old table
+  if (m_oldTable != nullptr) {
+    index = findIndex(name, block, hashVal, 2);
+    if (index != NOINDEX) {
+      return &m_oldTable[index];
+    }
+  }
+  return nullptr;
+}
+
+// Name: reserve
+// Desc: Grows the table ahead of time, so the next n files do not start a
+// rehash while they are inserted. The new table is the smallest one that
+// holds n files under the load limit; it is filled by the incremental
+// migration, or at once with now. Parameters:
+//    - n: the number of files the table has to hold, the number of names in
+//    GROUPSTORE
+//    - now: true to move every file into the new table before returning
+// Postconditions:
+//    - Returns true if a rehash was started, false if the table is big
+//    enough already or a running migration could not be finished.
+bool FileSys::reserve(size_t n, bool now) {
+  TableCap newCap = fitCap(n);
+  if (newCap.m_cap <= m_currentCap) {
+    return false;
+  }
+  return resize(newCap, now);
+}
+
+// Name: shrink_to_fit
+// Desc: Rehashes the table to the smallest capacity that holds the stored
+// files under the load limit, which also drops the deleted buckets. The next
+// insert may start a rehash again. Parameters:
+//    - now: true to move every file into the new table before returning
+// Postconditions:
+//    - Returns true if a rehash was started, false if the table is as small
+//    as it can be or a running migration could not be finished.
+bool FileSys::shrink_to_fit(bool now) {
+  TableCap newCap = fitCap(m_currentSize + m_oldSize);
+  if (newCap.m_cap >= m_currentCap) {
+    return false;
+  }
+  return resize(newCap, now);
+}
+
+// Name: resize
+// Desc: Starts a rehash to a given capacity, the migration that is running
+// is finished first since a table has at most one old table. Parameters:
+//    - newCap: the capacity of the new table and its fast modulus constant
+//    - now: true to finish the new migration before returning
+// Postconditions:
+//    - Returns true if the rehash was started.
+bool FileSys::resize(TableCap newCap, bool now) {
+  if (!finishMigration()) {
+    return false;
+  }
+  rehash(newCap);
+  if (now) {
+    finishMigration();
+  }
+  return true;
+}
+
+// Name: updateDiskBlock
+// Desc: Updates the block number of a File object in the database if it exists
+// Parameters:
+//    - file: the File object to be updated, containing the name and current
+//    block number
+//    - newBlock: the new block number to be set for the File object
+// Preconditions:
+//    - The hash table must be properly initialized and contain the provided
+//    File object
+// Postconditions:
+//    - If the File object is found in the database, its block number is updated
+//    to newBlock, and the function returns true
+//    - If the File object is not found, the function returns false
+bool FileSys::updateDiskBlock(const File &file, int newblock) {
+
+  // Search the current table first
+  unsigned int hashVal = hashName(file.m_name);
+  if (m_storeMode == GROUPSTORE) {
+    // the block moves within the group of the name, the slot stays put
+    const Slot *slot = findName(file.m_name, hashVal);
+    if (slot == nullptr || newblock < DISKMIN || newblock > DISKMAX) {
+      return false;
+    }
+    vector<int> &blocks = m_groups[slot->m_diskBlock];
+    vector<int>::iterator it =
+        lower_bound(blocks.begin(), blocks.end(), file.m_diskBlock);
+    if (it == blocks.end() || *it != file.m_diskBlock) {
+      return false;
+    }
+    if (newblock == file.m_diskBlock) {
+      return true; // nothing changes
+    }
+    if (binary_search(blocks.begin(), blocks.end(), newblock)) {
+      return false;
+    }
+    blocks.erase(it);
+    blocks.insert(lower_bound(blocks.begin(), blocks.end(), newblock),
+                  newblock);
+    fileRemoved(file.m_name, hashVal, file.m_diskBlock);
+    fileAdded(file.m_name, hashVal, newblock);
+    return true;
+  }
+  int table = 1;
+  size_t index = findIndex(file.m_name, file.m_diskBlock, hashVal, 1);
+
+  // If the file is not found in the current table, check the old table
+  if (index == NOINDEX && m_oldTable != nullptr) {
+    table = 2;
+    index = findIndex(file.m_name, file.m_diskBlock, hashVal, 2);
+  }
+
+  // If the file is not found in either table, or the new block would make it
+  // a duplicate of another file, return false
+  if (index == NOINDEX || newblock < DISKMIN || newblock > DISKMAX) {
+    return false;
+  }
+  if (newblock == file.m_diskBlock) {
+    return true; // nothing changes
+  }
+  if (findFile(file.m_name, newblock) != nullptr) {
+    return false;
+  }
+
+  Slot &slot = (table == 1) ? m_currentTable[index] : m_oldTable[index];
+  prob_t probing = (table == 1) ? m_currProbing : m_oldProbing;
+  if (probing == LINEAR || probing == QUADRATIC || probing == DOUBLEHASH) {
+    // File is found, now update block number, the tag depends on the block
+    slot.m_diskBlock = newblock;
+    setCtrl(index, mixHash(hashVal, newblock) >> 25, table);
+    nameIndexRemove(hashVal, file.m_diskBlock);
+    nameIndexAdd(hashVal, newblock, index);
+    fileRemoved(file.m_name, hashVal, file.m_diskBlock);
+    fileAdded(file.m_name, hashVal, newblock);
+    return true;
+  }
+
+  // The other policies place a file by its block too, so the file is stored
+  // again in the current table and then deleted from its bucket
+  string name = slot.m_name;
+  size_t newIndex = placeFile(name, newblock, hashVal);
+  if (newIndex == NOINDEX) {
+    return false;
+  }
+  // storing can move files or start a rehash, so the old entry is found again
+  table = 1;
+  index = findIndex(file.m_name, file.m_diskBlock, hashVal, 1);
+  if (index == NOINDEX) {
+    table = 2;
+    index = findIndex(file.m_name, file.m_diskBlock, hashVal, 2);
+  }
+  eraseSlot(index, table);
+  nameIndexRemove(hashVal, file.m_diskBlock);
+  nameIndexAdd(hashVal, newblock, newIndex);
+  fileRemoved(file.m_name, hashVal, file.m_diskBlock);
+  fileAdded(file.m_name, hashVal, newblock);
+  return true;
+}
+
+// Name: getFileByBlock
+// Desc: Finds the file that owns a disk block. The block index gives the hash
+// value of the owner's name, which leads to the probe sequence of the file,
+// and the file is matched by its hash value and block. Parameters:
+//    - block: the disk block number
+// Postconditions:
+//    - Returns the file stored under block, or an empty File if no file or
+//    more than one file is stored under it (blockOwners tells which).
+const File FileSys::getFileByBlock(int block) const {
+  if (blockOwners(block) != 1) {
+    return File();
+  }
+  unsigned int hashVal = m_owners[block - DISKMIN].m_hashSum;
+
+  // a block has one owner, so only that file has the hash value and block
+  for (int table = 1; table <= 2; table++) {
+    if (table == 2 && m_oldTable == nullptr) {
+      break;
+    }
+    size_t index = findIndex(ANYNAME, block & m_keyMask, hashVal, table);
+    const Slot *slots = (table == 1) ? m_currentTable : m_oldTable;
+    if (index == NOINDEX) {
+      continue;
+    }
+    if (m_storeMode != GROUPSTORE) {
+      return File(slots[index].m_name, block, true);
+    }
+    const vector<int> &group = m_groups[slots[index].m_diskBlock];
+    if (binary_search(group.begin(), group.end(), block)) {
+      return File(slots[index].m_name, block, true);
+    }
+    // In GROUPSTORE the slot is keyed by its name alone, another name with
+    // the same hash value was found first. Such a hash collision is rare, the
+    // tables are scanned for the owner then.
+    for (int scan = 1; scan <= 2; scan++) {
+      const Slot *scanSlots = (scan == 1) ? m_currentTable : m_oldTable;
+      const unsigned char *ctrl = (scan == 1) ? m_currCtrl : m_oldCtrl;
+      size_t cap = (scan == 1) ? m_currentCap : m_oldCap;
+      for (size_t i = 0; scanSlots != nullptr && i < cap; i++) {
+        if (ctrl[i] != CTRL_EMPTY && ctrl[i] != CTRL_DELETED &&
+            scanSlots[i].m_hash == hashVal) {
+          const vector<int> &blocks = m_groups[scanSlots[i].m_diskBlock];
+          if (binary_search(blocks.begin(), blocks.end(), block)) {
+            return File(scanSlots[i].m_name, block, true);
+          }
+        }
+      }
+    }
+  }
+  return File();
+}
+
+// Name: blockOwners
+// Desc: Counts the files stored under a disk block. Parameters:
+//    - block: the disk block number
+// Postconditions:
+//    - Returns the number of files stored under block, 0 for a block out of
+//    [DISKMIN, DISKMAX]. More than one owner means the files share the block.
+int FileSys::blockOwners(int block) const {
+  if (block < DISKMIN || block > DISKMAX) {
+    return 0;
+  }
+  buildBlockIndex();
+  return (int)m_owners[block - DISKMIN].m_count;
+}
+
+// Name: fileAdded
+// Desc: Adds a stored file to the block index and the ordered name index.
+// Parameters:
+//    - name: the name of the file
+//    - hashVal: the value of m_hash for name
+//    - block: the disk block number of the file
+void FileSys::fileAdded(string_view name, unsigned int hashVal, int block) {
+  ownBlock(hashVal, block);
+  if (m_ordered != nullptr) {
+    m_ordered->insert(name, block);
+  }
+}
+
+// Name: fileRemoved
+// Desc: Removes a file that is no longer stored from the block index and the
+// ordered name index. Parameters:
+//    - name: the name of the file
+//    - hashVal: the value of m_hash for name
+//    - block: the disk block number of the file
+void FileSys::fileRemoved(string_view name, unsigned int hashVal, int block) {
+  releaseBlock(hashVal, block);
+  if (m_ordered != nullptr) {
+    m_ordered->erase(name, block);
+  }
+}
+
+// Name: enableOrderedIndex
+// Desc: Starts the ordered name index, it is built from the stored files and
+// then kept up to date by every insert, remove and updateDiskBlock. A
+// migration moves files but does not change them, so it leaves the index
+// alone. Parameters: None
+// Postconditions:
+//    - scanPrefix reads the index from now on. Calling it again does nothing.
+void FileSys::enableOrderedIndex() {
+  if (m_ordered != nullptr) {
+    return;
+  }
+  m_ordered = new NameTree();
+  forEach([this](const string &name, int block) {
+    m_ordered->insert(name, block);
+  });
+}
 
-  // Use probing to search for the file in the hash table
-  while (index >= 0 && index < m_currentCap &&
-         m_currentTable[index] != nullptr) {
-    File *currentFile = m_currentTable[index];
-    string slotName = currentFile->getName();
-    int currBlock = currentFile->getDiskBlock();
+// Name: collectPrefix
+// Desc: Without the ordered name index, scanPrefix collects the files whose
+// name starts with prefix from both tables and sorts them. Parameters:
+//    - prefix: the start of the names
+//    - files: receives the files in ascending order of name and block
+void FileSys::collectPrefix(string_view prefix, vector<File> &files) const {
+  forEach([&](const string &name, int block) {
+    if (name.compare(0, prefix.size(), prefix) == 0) {
+      files.push_back(File(name, block, true));
+    }
+  });
+  sort(files.begin(), files.end(), [](const File &lhs, const File &rhs) {
+    int order = lhs.getName().compare(rhs.getName());
+    return order < 0 || (order == 0 && lhs.getDiskBlock() < rhs.getDiskBlock());
+  });
+}
+
+// Name: begin
+// Desc: Starts a walk over the stored files, the migration waits until the
+// walk reaches the end or the iterator is destroyed. A rehash can still
+// start during the walk, its new table takes new files until the files of
+// both tables reach its load limit, then an insert returns false until the
+// walk ends. Parameters: None
+// Postconditions:
+//    - Returns an iterator at the first file, or end() if there is none.
+FileSys::LiveIterator FileSys::begin() const { return LiveIterator(this); }
+
+// Name: end
+// Desc: The iterator a walk over the stored files ends at. Parameters: None
+FileSys::LiveIterator FileSys::end() const { return LiveIterator(nullptr); }
+
+// Name: LiveIterator
+// Desc: Starts a walk over the tables of a FileSys, or builds the end
+// iterator. The old table is walked first. A rehash during the walk turns
+// the current table into the old one, the walk keeps its pointers to both
+// since neither is deleted while the migration waits. Parameters:
+//    - filesys: the table to walk, nullptr for the end iterator
+// Postconditions:
+//    - The iterator is at the first live file, or at the end.
+FileSys::LiveIterator::LiveIterator(const FileSys *filesys)
+    : m_filesys(filesys), m_slots{nullptr, nullptr}, m_ctrl{nullptr, nullptr},
+      m_cap{0, 0}, m_table(2), m_index(0), m_block(0) {
+  if (filesys == nullptr) {
+    return;
+  }
+  filesys->m_iterators++;
+  if (filesys->m_oldTable != nullptr) {
+    m_slots[0] = filesys->m_oldTable;
+    m_ctrl[0] = filesys->m_oldCtrl;
+    m_cap[0] = filesys->m_oldCap;
+  }
+  m_slots[1] = filesys->m_currentTable;
+  m_ctrl[1] = filesys->m_currCtrl;
+  m_cap[1] = filesys->m_currentCap;
+  m_table = 0;
+  settle();
+}
+
+// Name: LiveIterator (copy)
+// Desc: A copy walks on its own, the migration waits for it as well.
+FileSys::LiveIterator::LiveIterator(const LiveIterator &other)
+    : m_filesys(other.m_filesys), m_slots{other.m_slots[0], other.m_slots[1]},
+      m_ctrl{other.m_ctrl[0], other.m_ctrl[1]},
+      m_cap{other.m_cap[0], other.m_cap[1]}, m_table(other.m_table),
+      m_index(other.m_index), m_block(other.m_block) {
+  if (m_filesys != nullptr) {
+    m_filesys->m_iterators++;
+  }
+}
+
+// Name: operator=
+// Desc: Takes over the position of other, the walk of this iterator ends.
+FileSys::LiveIterator &
+FileSys::LiveIterator::operator=(const LiveIterator &other) {
+  if (this != &other) {
+    release();
+    m_filesys = other.m_filesys;
+    for (int table = 0; table < 2; table++) {
+      m_slots[table] = other.m_slots[table];
+      m_ctrl[table] = other.m_ctrl[table];
+      m_cap[table] = other.m_cap[table];
+    }
+    m_table = other.m_table;
+    m_index = other.m_index;
+    m_block = other.m_block;
+    if (m_filesys != nullptr) {
+      m_filesys->m_iterators++;
+    }
+  }
+  return *this;
+}
 
-    if (currentFile->getUsed() && slotName == name && currBlock == block) {
-      return *currentFile;
-    }
+// Name: ~LiveIterator
+// Desc: Ends the walk if it did not reach the end.
+FileSys::LiveIterator::~LiveIterator() { release(); }
 
-    index = getNextIndex(index, originalIndex, jump, m_currentCap,
-                         originalIndex, 1);
-    jump++;
+// Name: operator++
+// Desc: Moves to the next file. In GROUPSTORE the next block of the group
+// is the first one above the block of the file, so a block added to or
+// removed from the group between steps does not shift the walk.
+// Preconditions:
+//    - The iterator is not at the end.
+// Postconditions:
+//    - The iterator is at the next live file, or at the end.
+FileSys::LiveIterator &FileSys::LiveIterator::operator++() {
+  if (m_filesys->m_storeMode != GROUPSTORE) {
+    m_index++;
   }
+  settle();
+  return *this;
+}
 
-  // If the file is not found in the current table, check the old table
-  if (m_oldTable != nullptr) {
-    index = m_hash(name) % m_oldCap;
-    originalIndex = index;
-    jump = 0;
+// Name: operator*
+// Desc: Returns a copy of the file the iterator is at.
+const File FileSys::LiveIterator::operator*() const {
+  return File(getName(), getDiskBlock(), true);
+}
 
-    while (index >= 0 && index < m_oldCap && m_oldTable[index] != nullptr) {
-      File *oldFile = m_oldTable[index];
-      string slotName = oldFile->getName();
-      int oldBlock = oldFile->getDiskBlock();
+// Name: getName
+// Desc: Returns the name of the file the iterator is at, without a copy.
+const string &FileSys::LiveIterator::getName() const {
+  return m_slots[m_table][m_index].m_name;
+}
 
-      if (oldFile->getUsed() && slotName == name && oldBlock == block) {
-        return *oldFile;
-      }
+// Name: getDiskBlock
+// Desc: Returns the disk block of the file the iterator is at.
+int FileSys::LiveIterator::getDiskBlock() const {
+  if (m_filesys->m_storeMode == GROUPSTORE) {
+    return m_block;
+  }
+  return m_slots[m_table][m_index].m_diskBlock;
+}
 
-      index =
-          getNextIndex(index, originalIndex, jump, m_oldCap, originalIndex, 2);
-      jump++;
+// Name: operator==
+// Desc: Two iterators are equal at the same file, or both at the end.
+bool FileSys::LiveIterator::operator==(const LiveIterator &other) const {
+  if (m_filesys == nullptr || other.m_filesys == nullptr) {
+    return m_filesys == other.m_filesys;
+  }
+  return m_filesys == other.m_filesys && m_table == other.m_table &&
+         m_index == other.m_index && m_block == other.m_block;
+}
+
+// Name: settle
+// Desc: Moves to the first live file from the position of the iterator on.
+// A slot removed since the last step is skipped by its control byte. In
+// GROUPSTORE a slot is left once its group has no block above m_block.
+// Postconditions:
+//    - The iterator is at a live file, or at the end and released.
+void FileSys::LiveIterator::settle() {
+  while (m_table < 2) {
+    size_t live = nextLive(m_ctrl[m_table], m_index, m_cap[m_table]);
+    if (live != m_index) {
+      m_block = 0; // the slot of m_block was removed
     }
+    m_index = live;
+    if (m_index == m_cap[m_table]) {
+      m_table++;
+      m_index = 0;
+      m_block = 0;
+      continue;
+    }
+    if (m_filesys->m_storeMode != GROUPSTORE) {
+      return;
+    }
+    const vector<int> &group =
+        m_filesys->m_groups[m_slots[m_table][m_index].m_diskBlock];
+    vector<int>::const_iterator next =
+        upper_bound(group.begin(), group.end(), m_block);
+    if (next != group.end()) {
+      m_block = *next;
+      return;
+    }
+    m_index++;
+    m_block = 0;
   }
+  release();
+}
 
-  // Return an empty File object if the file is not found
-  return File();
+// Name: release
+// Desc: Ends the walk, the migration of the table goes on with its next
+// operation. Calling it again does nothing.
+void FileSys::LiveIterator::release() {
+  if (m_filesys != nullptr) {
+    m_filesys->m_iterators--;
+    m_filesys = nullptr;
+  }
+  m_table = 2;
 }
 
-// Name: updateDiskBlock
-// Desc: Updates the block number of a File object in the database if it exists
-// Parameters:
-//    - file: the File object to be updated, containing the name and current
-//    block number
-//    - newBlock: the new block number to be set for the File object
-// Preconditions:
-//    - The hash table must be properly initialized and contain the provided
-//    File object
+// Name: buildBlockIndex
+// Desc: Allocates the block index and the allocator bitmaps the first time a
+// block is looked up or allocated and fills them from the stored files, a
+// table that never does so (like the directory tables of a DirTree) does not
+// pay for them. From then on every insert, remove and updateDiskBlock keeps
+// them up to date. Parameters: None
 // Postconditions:
-//    - If the File object is found in the database, its block number is updated
-//    to newBlock, and the function returns true
-//    - If the File object is not found, the function returns false
-bool FileSys::updateDiskBlock(File file, int newblock) {
-
-  // Calculate the initial index using the hash function for the current table
-  int index = m_hash(file.getName()) % m_currentCap;
-  int originalIndex = index;
-  int jump = 0;
-  File *currFile = m_currentTable[index];
-  // Search the current table first
+//    - m_owners, m_usedBlocks and m_fullWords describe the stored files.
+void FileSys::buildBlockIndex() const {
+  if (m_owners != nullptr) {
+    return;
+  }
 
-  while (currFile != nullptr) {
+  // every block of the disk has an entry, no file owns one yet
+  m_owners = new BlockOwner[NUMBLOCKS];
 
-    if (m_currentTable[index]->getUsed() && *currFile == file) {
+  // every block is free, the bits after DISKMAX in the last word are used so
+  // they are never allocated, and so are the bits after the last word
+  m_usedBlocks = new uint64_t[BLOCKWORDS]();
+  m_fullWords = new uint64_t[FULLWORDS]();
+  if (NUMBLOCKS % 64 != 0) {
+    m_usedBlocks[BLOCKWORDS - 1] = ~0ULL << (NUMBLOCKS % 64);
+  }
+  if (BLOCKWORDS % 64 != 0) {
+    m_fullWords[FULLWORDS - 1] = ~0ULL << (BLOCKWORDS % 64);
+  }
 
-      // File is found, now update block number
-      currFile->setDiskBlock(newblock);
-      return true;
+  visitSlots([this](const Slot &slot) {
+    if (m_storeMode == GROUPSTORE) {
+      for (int block : m_groups[slot.m_diskBlock])
+        ownBlock(slot.m_hash, block);
+    } else {
+      ownBlock(slot.m_hash, slot.m_diskBlock);
     }
+  });
+}
 
-    index = getNextIndex(index, originalIndex, jump, m_currentCap,
-                         originalIndex, 1);
-    jump++;
+// Name: ownBlock
+// Desc: Adds a file to the owners of its block in the block index.
+// Parameters:
+//    - hashVal: the value of m_hash for the name of the file
+//    - block: the disk block number of the file, in [DISKMIN, DISKMAX]
+void FileSys::ownBlock(unsigned int hashVal, int block) const {
+  if (m_owners == nullptr) {
+    return; // the index is built from the tables when it is first read
   }
+  BlockOwner &owner = m_owners[block - DISKMIN];
+  owner.m_hashSum += hashVal;
+  if (owner.m_count++ == 0) {
+    markBlock(block, true);
+  }
+}
 
-  // If the file is not found in the current table, check the old table
-  if (m_oldTable != nullptr) {
-    index = m_hash(file.getName()) % m_oldCap;
-    originalIndex = index;
-    jump = 0;
-    File *oldFile = m_oldTable[index];
+// Name: releaseBlock
+// Desc: Removes a file from the owners of its block in the block index.
+// Parameters:
+//    - hashVal: the value of m_hash for the name of the file
+//    - block: the disk block number of the file, in [DISKMIN, DISKMAX]
+void FileSys::releaseBlock(unsigned int hashVal, int block) {
+  if (m_owners == nullptr) {
+    return;
+  }
+  BlockOwner &owner = m_owners[block - DISKMIN];
+  owner.m_hashSum -= hashVal;
+  if (--owner.m_count == 0) {
+    markBlock(block, false);
+  }
+}
 
-    while (oldFile != nullptr) {
+// Name: create
+// Desc: Inserts a file under a block the allocator picks, the first free
+// block from the word of the last allocation on. Parameters:
+//    - name: the name of the file
+// Postconditions:
+//    - Returns the block the file is stored under, or 0 if every block of
+//    [DISKMIN, DISKMAX] is used or the table has no free bucket. The block is
+//    free again once its file is removed.
+int FileSys::create(string_view name) {
+  buildBlockIndex();
+  int block = findFreeBlock();
+  if (block == 0 || !emplace(name, block)) {
+    return 0;
+  }
+  return block;
+}
 
-      if (m_oldTable[index]->getUsed() && *oldFile == file) {
-        // File is found, now update block number
-        m_oldTable[index]->setDiskBlock(newblock);
-        return true;
-      }
+// Name: findFreeBlock
+// Desc: Searches the allocator bitmaps for a free block. A word of the full
+// bitmap covers 64 words of the block bitmap, so at most FULLWORDS + 1 words
+// of it are read before the search wraps around to m_allocWord.
+// Postconditions:
+//    - Returns the first free block in the first word from m_allocWord on that
+//    has one, or 0 if no block is free. m_allocWord moves to that word.
+int FileSys::findFreeBlock() {
+  size_t start = m_allocWord / 64;
+  for (size_t step = 0; step <= FULLWORDS; step++) {
+    size_t summary = (start + step) % FULLWORDS;
+    uint64_t open = ~m_fullWords[summary];
+    if (step == 0) {
+      // the first pass begins at the word of the last allocation
+      open &= ~0ULL << (m_allocWord % 64);
+    }
+    if (open != 0) {
+      size_t word = summary * 64 + __builtin_ctzll(open);
+      m_allocWord = word;
+      return DISKMIN + (int)(word * 64 + __builtin_ctzll(~m_usedBlocks[word]));
+    }
+  }
+  return 0;
+}
+
+// Name: markBlock
+// Desc: Sets or clears the bit of a block in the allocator, the full bitmap
+// follows its word. Parameters:
+//    - block: the disk block number, in [DISKMIN, DISKMAX]
+//    - used: true if a file is now stored under the block, false if none is
+void FileSys::markBlock(int block, bool used) const {
+  size_t bit = block - DISKMIN;
+  size_t word = bit / 64;
+  if (used) {
+    m_usedBlocks[word] |= 1ULL << (bit % 64);
+    m_numUsedBlocks++;
+    if (m_usedBlocks[word] == ~0ULL) {
+      m_fullWords[word / 64] |= 1ULL << (word % 64);
+    }
+  } else {
+    m_usedBlocks[word] &= ~(1ULL << (bit % 64));
+    m_numUsedBlocks--;
+    m_fullWords[word / 64] &= ~(1ULL << (word % 64));
+  }
+}
+
+// Name: freeBlocks
+// Desc: Counts the blocks of [DISKMIN, DISKMAX] no file is stored under.
+size_t FileSys::freeBlocks() const {
+  buildBlockIndex();
+  return NUMBLOCKS - m_numUsedBlocks;
+}
 
-      index =
-          getNextIndex(index, originalIndex, jump, m_oldCap, originalIndex, 2);
-      jump++;
+// Name: fragmentation
+// Desc: Measures how scattered the free blocks are, one minus the share of
+// the free blocks that lie in the largest run of free blocks. Free and full
+// words are passed whole, the runs of the other words are found with bit
+// scans. Parameters: None
+// Postconditions:
+//    - Returns 0 if the free blocks form one run (or none is free), and a
+//    value close to 1 if no two free blocks are next to each other.
+float FileSys::fragmentation() const {
+  buildBlockIndex();
+  size_t largest = 0;
+  size_t run = 0; // length of the run that reaches the current bit
+  for (size_t word = 0; word < BLOCKWORDS; word++) {
+    uint64_t freeBits = ~m_usedBlocks[word];
+    if (freeBits == ~0ULL) {
+      run += 64;
+      continue;
+    }
+    size_t pos = 0;
+    while (pos < 64) {
+      uint64_t rest = freeBits >> pos;
+      if (rest & 1) {
+        // a free run, it ends at the next used block
+        size_t length = __builtin_ctzll(~rest);
+        run += length;
+        pos += length;
+      } else {
+        largest = max(largest, run);
+        run = 0;
+        if (rest == 0) {
+          break;
+        }
+        pos += __builtin_ctzll(rest);
+      }
     }
   }
+  largest = max(largest, run);
 
-  // If the file is not found in either table, return false
-  return false;
+  size_t free = freeBlocks();
+  if (free == 0) {
+    return 0.0;
+  }
+  return 1.0 - (float)largest / free;
 }
 
 // Name: lambda
@@ -696,42 +3158,738 @@ float FileSys::deletedRatio() const {
 void FileSys::dump() const {
   cout << "Dump for the current table: " << endl;
   if (m_currentTable != nullptr)
-    for (int i = 0; i < m_currentCap; i++) {
-      cout << "[" << i << "] : " << m_currentTable[i] << endl;
+    for (size_t i = 0; i < m_currentCap; i++) {
+      dumpSlot(i, 1);
     }
   cout << "f for the old table: " << endl;
   if (m_oldTable != nullptr)
-    for (int i = 0; i < m_oldCap; i++) {
-      cout << "[" << i << "] : " << m_oldTable[i] << endl;
+    for (size_t i = 0; i < m_oldCap; i++) {
+      dumpSlot(i, 2);
     }
 }
 
-bool FileSys::isPrime(int number) {
-  bool result = true;
-  for (int i = 2; i <= number / 2; ++i) {
-    if (number % i == 0) {
-      result = false;
-      break;
+// Name: dumpSlot
+// Desc: Prints one bucket of a table in the format used by dump, an empty
+// bucket prints no file. Parameters:
+//    - index: the slot index
+//    - table: 1 for the current table, 2 for the old table
+void FileSys::dumpSlot(size_t index, int table) const {
+  const Slot &slot = (table == 1) ? m_currentTable[index] : m_oldTable[index];
+  unsigned char ctrl = (table == 1) ? m_currCtrl[index] : m_oldCtrl[index];
+  cout << "[" << index << "] : ";
+  if (ctrl != CTRL_EMPTY && ctrl != CTRL_DELETED &&
+      m_storeMode == GROUPSTORE) {
+    // the blocks of the name, a deleted slot no longer has a group
+    cout << slot.m_name << " (";
+    for (int block : m_groups[slot.m_diskBlock]) {
+      cout << block << ", ";
+    }
+    cout << "1)";
+  } else if (ctrl != CTRL_EMPTY) {
+    cout << slot.m_name << " (" << slot.m_diskBlock << ", "
+         << (ctrl != CTRL_DELETED) << ")";
+  }
+  cout << endl;
+}
+
+// Name: mulMod
+// Desc: Multiplies two residues modulo m without overflowing 64 bits.
+static constexpr uint64_t mulMod(uint64_t a, uint64_t b, uint64_t m) {
+  return (uint64_t)((__uint128_t)a * b % m);
+}
+
+// Name: powMod
+// Desc: Raises base to the power exp modulo m by repeated squaring.
+static constexpr uint64_t powMod(uint64_t base, uint64_t exp, uint64_t m) {
+  uint64_t result = 1;
+  base %= m;
+  while (exp > 0) {
+    if (exp & 1) {
+      result = mulMod(result, base, m);
     }
+    base = mulMod(base, base, m);
+    exp >>= 1;
   }
   return result;
 }
 
-// Function to find the next prime number greater than or equal to current
-int FileSys::findNextPrime(int current) {
-  // we always stay within the range [MINPRIME-MAXPRIME]
-  // the smallest prime starts at MINPRIME
-  if (current < MINPRIME)
-    current = MINPRIME - 1;
-  for (int i = current; i < MAXPRIME; i++) {
-    for (int j = 2; j * j <= i; j++) {
-      if (i % j == 0)
-        break;
-      else if (j + 1 > sqrt(i) && i != current) {
-        return i;
+// Name: primeTest
+// Desc: Checks a number with trial division by the small primes and then a
+// Miller-Rabin test. The first 12 primes as witnesses make the test exact for
+// every 64 bit number. Parameters:
+//    - number: the number to check
+// Postconditions:
+//    - Returns true if number is a prime number.
+static constexpr bool primeTest(uint64_t number) {
+  const uint64_t witnesses[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+  if (number < 2) {
+    return false;
+  }
+  for (uint64_t p : witnesses) {
+    if (number % p == 0) {
+      return number == p;
+    }
+  }
+
+  // number - 1 = odd * 2^twos
+  uint64_t odd = number - 1;
+  int twos = 0;
+  while ((odd & 1) == 0) {
+    odd >>= 1;
+    twos++;
+  }
+  for (uint64_t p : witnesses) {
+    uint64_t x = powMod(p, odd, number);
+    if (x == 1 || x == number - 1) {
+      continue;
+    }
+    bool composite = true;
+    for (int i = 1; i < twos && composite; i++) {
+      x = mulMod(x, x, number);
+      composite = (x != number - 1);
+    }
+    if (composite) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The prime capacities, generated while compiling. Entry k is the smallest
+// prime at or above a target that starts at MINPRIME and grows by
+// 1/PRIMEGROWTH every step, each prime is stored with its fast modulus
+// constant.
+struct PrimeCapTable {
+  TableCap m_caps[NUMPRIMECAPS];
+};
+
+static constexpr PrimeCapTable makePrimeCaps() {
+  PrimeCapTable table;
+  uint64_t target = MINPRIME;
+  for (int k = 0; k < NUMPRIMECAPS; k++) {
+    uint64_t prime = target;
+    while (!primeTest(prime)) {
+      prime++;
+    }
+    table.m_caps[k].m_cap = prime;
+    table.m_caps[k].m_magic = modMagic(prime);
+    target += target / PRIMEGROWTH;
+  }
+  return table;
+}
+
+static constexpr PrimeCapTable PRIMECAPS = makePrimeCaps();
+static_assert(PRIMECAPS.m_caps[0].m_cap == MINPRIME,
+              "the smallest prime capacity must be MINPRIME");
+static_assert(PRIMECAPS.m_caps[NUMPRIMECAPS - 1].m_cap > (1ull << 61),
+              "NUMPRIMECAPS must reach 2^62");
+
+// Name: isPrime
+// Desc: Checks a number for primality without trial division up to its
+// square root. Parameters:
+//    - number: the number to check
+// Postconditions:
+//    - Returns true if number is a prime number.
+bool FileSys::isPrime(size_t number) { return primeTest(number); }
+
+// Name: primeCapAtLeast
+// Desc: Looks up the prime capacity of a new table with a binary search of the
+// compile time table. Parameters:
+//    - size: the requested capacity
+// Postconditions:
+//    - Returns the smallest prime capacity that is at least size and at least
+//    MINPRIME, together with its fast modulus constant. A size beyond the
+//    table falls back to the next prime number.
+TableCap FileSys::primeCapAtLeast(size_t size) {
+  const TableCap *caps = PRIMECAPS.m_caps;
+  int low = 0;
+  int high = NUMPRIMECAPS;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (caps[mid].m_cap < size) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low < NUMPRIMECAPS) {
+    return caps[low];
+  }
+
+  TableCap beyond;
+  beyond.m_cap = size;
+  while (!primeTest(beyond.m_cap)) {
+    beyond.m_cap++;
+  }
+  beyond.m_magic = modMagic(beyond.m_cap);
+  return beyond;
+}
+
+// Function to find the next prime capacity greater than current
+size_t FileSys::findNextPrime(size_t current) {
+  // the smallest prime starts at MINPRIME, there is no upper limit so the
+  // table keeps growing with the data
+  return primeCapAtLeast(current + 1).m_cap;
+}
+
+// Name: NameTree::NameTree
+// Desc: Constructor for the NameTree class, the tree starts as an empty leaf.
+NameTree::NameTree() {
+  m_root = new Node();
+  m_size = 0;
+}
+
+// Name: NameTree::~NameTree
+// Desc: Destructor for the NameTree class, deletes every node.
+NameTree::~NameTree() {
+  freeNode(m_root);
+  m_root = nullptr;
+}
+
+// Name: insert
+// Desc: Adds a key to the tree. A full node on the path splits in two halves,
+// a split of the root adds a level above it. Parameters:
+//    - name: the name of the file
+//    - block: the disk block number of the file
+// Postconditions:
+//    - Returns true if the key was added, false if it was already there.
+bool NameTree::insert(string_view name, int block) {
+  bool added = false;
+  Node *split = insertInto(m_root, name, block, added);
+  if (split != nullptr) {
+    Node *root = new Node();
+    root->m_leaf = false;
+    addKey(root, 0, m_root->m_names[0], m_root->m_blocks[0], m_root);
+    addKey(root, 1, split->m_names[0], split->m_blocks[0], split);
+    m_root = root;
+  }
+  if (added) {
+    m_size++;
+  }
+  return added;
+}
+
+// Name: erase
+// Desc: Removes a key from the tree, nodes that run empty are freed and a
+// root with one child is replaced by the child. Parameters:
+//    - name: the name of the file
+//    - block: the disk block number of the file
+// Postconditions:
+//    - Returns true if the key was removed, false if it was not there.
+bool NameTree::erase(string_view name, int block) {
+  bool removed = false;
+  if (eraseFrom(m_root, name, block, removed) && !m_root->m_leaf) {
+    delete m_root; // its children are freed already
+    m_root = new Node();
+  }
+  while (!m_root->m_leaf && m_root->m_count == 1) {
+    Node *child = m_root->m_children[0];
+    delete m_root;
+    m_root = child;
+  }
+  if (removed) {
+    m_size--;
+  }
+  return removed;
+}
+
+// Name: compareKey
+// Desc: Orders a key against the key at pos of a node, by name and then by
+// block. Postconditions: Returns a negative value, 0 or a positive value.
+int NameTree::compareKey(string_view name, int block, const Node *node,
+                         int pos) {
+  int order = name.compare(node->m_names[pos]);
+  if (order != 0) {
+    return order;
+  }
+  return (block < node->m_blocks[pos]) ? -1 : (block > node->m_blocks[pos]);
+}
+
+// Name: lowerPos
+// Desc: Binary search of a leaf. Postconditions: Returns the first position
+// whose key is not below (name, block), m_count if there is none.
+int NameTree::lowerPos(const Node *node, string_view name, int block) {
+  int low = 0;
+  int high = node->m_count;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (compareKey(name, block, node, mid) > 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+// Name: childFor
+// Desc: Binary search of an inner node. Postconditions: Returns the last child
+// whose smallest key is not above (name, block), or child 0.
+int NameTree::childFor(const Node *node, string_view name, int block) {
+  int low = 1;
+  int high = node->m_count;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (compareKey(name, block, node, mid) >= 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low - 1;
+}
+
+// Name: lowerBound
+// Desc: Finds where a prefix scan starts. Parameters:
+//    - prefix: the start of the names
+//    - pos: set to the position in the returned leaf
+// Postconditions:
+//    - Returns the leaf of the first key whose name is not below prefix, pos
+//    may be the end of the leaf, then the key is in the next leaf.
+const NameTree::Node *NameTree::lowerBound(string_view prefix, int &pos) const {
+  const Node *node = m_root;
+  while (!node->m_leaf) {
+    node = node->m_children[childFor(node, prefix, INT32_MIN)];
+  }
+  pos = lowerPos(node, prefix, INT32_MIN);
+  return node;
+}
+
+// Name: insertInto
+// Desc: Adds a key to the subtree of node. Parameters:
+//    - node: the root of the subtree
+//    - name, block: the key
+//    - added: set to true if the key was added
+// Postconditions:
+//    - Returns the new right sibling of node if node was split, else nullptr.
+//    The smallest key of node is kept up to date.
+NameTree::Node *NameTree::insertInto(Node *node, string_view name, int block,
+                                     bool &added) {
+  if (node->m_leaf) {
+    int pos = lowerPos(node, name, block);
+    if (pos < node->m_count && compareKey(name, block, node, pos) == 0) {
+      return nullptr;
+    }
+    added = true;
+    return addKey(node, pos, name, block, nullptr);
+  }
+
+  int child = childFor(node, name, block);
+  Node *split = insertInto(node->m_children[child], name, block, added);
+  if (added && child == 0 && compareKey(name, block, node, 0) < 0) {
+    node->m_names[0].assign(name.data(), name.size());
+    node->m_blocks[0] = block;
+  }
+  if (split == nullptr) {
+    return nullptr;
+  }
+  return addKey(node, child + 1, split->m_names[0], split->m_blocks[0], split);
+}
+
+// Name: eraseFrom
+// Desc: Removes a key from the subtree of node, a child that runs empty is
+// freed. Parameters:
+//    - node: the root of the subtree
+//    - name, block: the key
+//    - removed: set to true if the key was removed
+// Postconditions:
+//    - Returns true if node has no key left. The smallest key of node is kept
+//    up to date.
+bool NameTree::eraseFrom(Node *node, string_view name, int block,
+                         bool &removed) {
+  if (node->m_leaf) {
+    int pos = lowerPos(node, name, block);
+    if (pos == node->m_count || compareKey(name, block, node, pos) != 0) {
+      return false;
+    }
+    takeKey(node, pos);
+    removed = true;
+    return node->m_count == 0;
+  }
+
+  int child = childFor(node, name, block);
+  Node *next = node->m_children[child];
+  if (eraseFrom(next, name, block, removed)) {
+    if (next->m_leaf) {
+      // the leaf leaves the chain of leaves
+      if (next->m_prev != nullptr)
+        next->m_prev->m_next = next->m_next;
+      if (next->m_next != nullptr)
+        next->m_next->m_prev = next->m_prev;
+    }
+    delete next;
+    takeKey(node, child);
+  } else if (removed) {
+    node->m_names[child] = next->m_names[0];
+    node->m_blocks[child] = next->m_blocks[0];
+  }
+  return node->m_count == 0;
+}
+
+// Name: addKey
+// Desc: Puts a key (and the child of an inner node) at pos of a node. A full
+// node keeps its lower half and moves its upper half to a new right sibling
+// first, a leaf links the sibling into the chain of leaves. Parameters:
+//    - node: the node
+//    - pos: the position of the key in node before a split
+//    - name, block: the key
+//    - child: the child of the key, nullptr in a leaf
+// Postconditions:
+//    - Returns the new right sibling, or nullptr if node had room.
+NameTree::Node *NameTree::addKey(Node *node, int pos, string_view name,
+                                 int block, Node *child) {
+  Node *right = nullptr;
+  if (node->m_count == TREEFANOUT) {
+    right = new Node();
+    right->m_leaf = node->m_leaf;
+    int half = TREEFANOUT / 2;
+    for (int i = half; i < TREEFANOUT; i++) {
+      moveKey(node, i, right, i - half);
+    }
+    right->m_count = TREEFANOUT - half;
+    node->m_count = half;
+    if (node->m_leaf) {
+      right->m_next = node->m_next;
+      right->m_prev = node;
+      if (node->m_next != nullptr)
+        node->m_next->m_prev = right;
+      node->m_next = right;
+    }
+    if (pos > half) {
+      node = right;
+      pos -= half;
+    }
+  }
+
+  for (int i = node->m_count; i > pos; i--) {
+    moveKey(node, i - 1, node, i);
+  }
+  node->m_names[pos].assign(name.data(), name.size());
+  node->m_blocks[pos] = block;
+  node->m_children[pos] = child;
+  node->m_count++;
+  return right;
+}
+
+// Name: takeKey
+// Desc: Removes the key (and child) at pos of a node, the keys after it move
+// down one position.
+void NameTree::takeKey(Node *node, int pos) {
+  for (int i = pos + 1; i < node->m_count; i++) {
+    moveKey(node, i, node, i - 1);
+  }
+  node->m_count--;
+  node->m_names[node->m_count].clear();
+}
+
+// Name: moveKey
+// Desc: Moves the key and child at fromPos of one node to toPos of another
+// (or the same) node, the name is swapped instead of copied.
+void NameTree::moveKey(Node *from, int fromPos, Node *to, int toPos) {
+  to->m_names[toPos].swap(from->m_names[fromPos]);
+  to->m_blocks[toPos] = from->m_blocks[fromPos];
+  to->m_children[toPos] = from->m_children[fromPos];
+}
+
+// Name: freeNode
+// Desc: Deletes a node and every node below it.
+void NameTree::freeNode(Node *node) {
+  if (!node->m_leaf) {
+    for (int i = 0; i < node->m_count; i++) {
+      freeNode(node->m_children[i]);
+    }
+  }
+  delete node;
+}
+
+// Name: DirTree::DirTree
+// Desc: Constructor for the DirTree class, creates the root directory.
+// Parameters:
+//    - hash: the hash function of the directory tables
+//    - probing: the collision handling policy of the directory tables
+// Postconditions:
+//    - The tree holds an empty root directory, its path is "" or "/".
+DirTree::DirTree(hash_fn hash, prob_t probing)
+    : DirTree((view_hash_fn) nullptr, probing) {
+  m_hash = hash;
+  m_dirs[0].m_files->m_hash = hash;
+  m_dirs[0].m_subdirs->m_hash = hash;
+}
+
+// Name: DirTree::DirTree
+// Desc: Constructor for the DirTree class that hashes a string_view of each
+// name. Parameters:
+//    - hash: the hash function of the directory tables
+//    - probing: the collision handling policy of the directory tables
+// Postconditions:
+//    - The tree holds an empty root directory, its path is "" or "/".
+DirTree::DirTree(view_hash_fn hash, prob_t probing) {
+  m_hash = nullptr;
+  m_viewHash = hash;
+  m_probing = probing;
+  newDir(-1);
+}
+
+// Name: DirTree::~DirTree
+// Desc: Destructor for the DirTree class, deletes the tables of every
+// directory.
+DirTree::~DirTree() {
+  for (Dir &dir : m_dirs) {
+    delete dir.m_files;
+    delete dir.m_subdirs;
+  }
+}
+
+// Name: mkdir
+// Desc: Creates an empty directory. Parameters:
+//    - path: the path of the directory, names separated by '/'
+// Postconditions:
+//    - Returns true if the directory was created. The parent directory must
+//    exist and hold no file or directory with the same name, and there can be
+//    at most DISKMAX - DISKMIN + 1 directories. No tables are made for a
+//    directory its parent has no room for.
+bool DirTree::mkdir(string_view path) {
+  string_view name;
+  int parent = splitPath(path, name);
+  if (parent < 0 || childDir(parent, name) >= 0 || hasFiles(parent, name) ||
+      m_dirs.size() >= (size_t)NUMBLOCKS) {
+    return false;
+  }
+  // the entry is stored first, a directory is only made for an entry
+  if (!m_dirs[parent].m_subdirs->emplace(name, DISKMIN + m_dirs.size())) {
+    return false;
+  }
+  newDir(parent);
+  return true;
+}
+
+// Name: insert
+// Desc: Stores a file in its directory. Parameters:
+//    - path: the path of the file
+//    - block: the disk block number of the file
+// Postconditions:
+//    - Returns true if the file was stored. The directory must exist and have
+//    no subdirectory with the name of the file, the rules of FileSys::insert
+//    apply to the name and block.
+bool DirTree::insert(string_view path, int block) {
+  string_view name;
+  int dir = splitPath(path, name);
+  if (dir < 0 || childDir(dir, name) >= 0) {
+    return false;
+  }
+  return m_dirs[dir].m_files->emplace(name, block);
+}
+
+// Name: remove
+// Desc: Removes a file from its directory. Parameters:
+//    - path: the path of the file
+//    - block: the disk block number of the file
+// Postconditions:
+//    - Returns true if the file was stored and is removed.
+bool DirTree::remove(string_view path, int block) {
+  string_view name;
+  int dir = splitPath(path, name);
+  if (dir < 0) {
+    return false;
+  }
+  return m_dirs[dir].m_files->remove(File(string(name), block, true));
+}
+
+// Name: findFile
+// Desc: Looks up a file by its path. Parameters:
+//    - path: the path of the file
+//    - block: the disk block number of the file
+// Postconditions:
+//    - Returns the slot of the file in its directory, it holds the name of the
+//    file within the directory. nullptr if the file is not stored.
+const Slot *DirTree::findFile(string_view path, int block) const {
+  string_view name;
+  int dir = splitPath(path, name);
+  if (dir < 0) {
+    return nullptr;
+  }
+  return m_dirs[dir].m_files->findFile(name, block);
+}
+
+// Name: list
+// Desc: Lists a directory from its own tables, the cost depends on the number
+// of entries in the directory and not on the rest of the tree. Parameters:
+//    - path: the path of the directory
+// Postconditions:
+//    - Returns the names of the subdirectories, each with a '/' at the end,
+//    followed by the names of the files, every name once in hash order. An
+//    empty vector if the directory does not exist or is empty.
+vector<string> DirTree::list(string_view path) const {
+  vector<string> names;
+  int dir = findDir(path);
+  if (dir < 0) {
+    return names;
+  }
+  m_dirs[dir].m_subdirs->visitSlots(
+      [&names](const Slot &slot) { names.push_back(slot.getName() + "/"); });
+  m_dirs[dir].m_files->visitSlots(
+      [&names](const Slot &slot) { names.push_back(slot.getName()); });
+  return names;
+}
+
+// Name: rename
+// Desc: Moves a directory, or all the files with one name, to a new path. A
+// directory keeps its number and tables, only its entry moves from the old
+// parent to the new one. Parameters:
+//    - from: the path of a directory or of files
+//    - to: the new path, its directory must exist and hold no entry with the
+//    new name
+// Postconditions:
+//    - Returns true if the entry was moved. A directory can not be moved into
+//    itself or below itself. If the new parent has no room for the entry,
+//    nothing moves and false is returned.
+bool DirTree::rename(string_view from, string_view to) {
+  string_view fromName;
+  string_view toName;
+  int fromParent = splitPath(from, fromName);
+  int toParent = splitPath(to, toName);
+  if (fromParent < 0 || toParent < 0 || childDir(toParent, toName) >= 0 ||
+      hasFiles(toParent, toName)) {
+    return false;
+  }
+
+  int dir = childDir(fromParent, fromName);
+  if (dir >= 0) {
+    // the new parent must not be the directory or one of its descendants
+    for (int up = toParent; up >= 0; up = m_dirs[up].m_parent) {
+      if (up == dir) {
+        return false;
+      }
+    }
+    if (!m_dirs[toParent].m_subdirs->emplace(toName, DISKMIN + dir)) {
+      return false;
+    }
+    m_dirs[fromParent].m_subdirs->remove(
+        File(string(fromName), DISKMIN + dir, true));
+    m_dirs[dir].m_parent = toParent;
+    return true;
+  }
+
+  // the files of the name move with all their blocks
+  FileSys *source = m_dirs[fromParent].m_files;
+  vector<int> blocks = source->findAll(fromName);
+  if (blocks.empty()) {
+    return false;
+  }
+  // every block is stored under the new name before one is removed, a
+  // block the target refuses undoes the blocks that moved
+  FileSys *target = m_dirs[toParent].m_files;
+  for (size_t i = 0; i < blocks.size(); i++) {
+    if (!target->emplace(toName, blocks[i])) {
+      File moved(string(toName), 0, true);
+      for (size_t j = 0; j < i; j++) {
+        moved.setDiskBlock(blocks[j]);
+        target->remove(moved);
       }
+      return false;
+    }
+  }
+  File file(string(fromName), 0, true);
+  for (int block : blocks) {
+    file.setDiskBlock(block);
+    source->remove(file);
+  }
+  return true;
+}
+
+// Name: newDir
+// Desc: Creates the tables of a new directory. Parameters:
+//    - parent: the number of the parent directory, -1 for the root
+// Postconditions:
+//    - Returns the number of the directory in m_dirs.
+int DirTree::newDir(int parent) {
+  int dir = (int)m_dirs.size();
+  m_dirs.emplace_back();
+  // the directory tables never look up disk blocks, so they never build the
+  // block index; a directory is keyed by name alone so it has one slot per
+  // name
+  Dir &entry = m_dirs[dir];
+  entry.m_files =
+      new FileSys(MINPRIME, m_viewHash, m_probing, PRIMECAP, GROUPSTORE);
+  entry.m_subdirs =
+      new FileSys(MINPRIME, m_viewHash, m_probing, PRIMECAP, GROUPSTORE);
+  entry.m_files->m_hash = m_hash;
+  entry.m_subdirs->m_hash = m_hash;
+  entry.m_parent = parent;
+  return dir;
+}
+
+// Name: childDir
+// Desc: Looks up a subdirectory by its name. Parameters:
+//    - dir: the number of the parent directory
+//    - name: the name of the subdirectory
+// Postconditions:
+//    - Returns the number of the subdirectory, or -1 if dir has none with the
+//    name.
+int DirTree::childDir(int dir, string_view name) const {
+  const FileSys *dirs = m_dirs[dir].m_subdirs;
+  const Slot *slot = dirs->findName(name, dirs->hashName(name));
+  if (slot == nullptr) {
+    return -1;
+  }
+  return dirs->m_groups[slot->getDiskBlock()][0] - DISKMIN;
+}
+
+// Name: hasFiles
+// Desc: Checks whether a directory has a file with the given name.
+// Parameters:
+//    - dir: the number of the directory
+//    - name: the name of the file
+// Postconditions:
+//    - Returns true if at least one file of dir has the name.
+bool DirTree::hasFiles(int dir, string_view name) const {
+  const FileSys *files = m_dirs[dir].m_files;
+  return files->findName(name, files->hashName(name)) != nullptr;
+}
+
+// Name: findDir
+// Desc: Resolves the path of a directory one name at a time. Parameters:
+//    - path: the path, names separated by '/', "" and "/" are the root
+// Postconditions:
+//    - Returns the number of the directory, or -1 if a name on the path is
+//    not a directory. Empty names, like the one in "a//b", are skipped.
+int DirTree::findDir(string_view path) const {
+  int dir = 0;
+  size_t pos = 0;
+  while (dir >= 0 && pos < path.size()) {
+    size_t end = path.find('/', pos);
+    if (end == string_view::npos) {
+      end = path.size();
+    }
+    if (end > pos) {
+      dir = childDir(dir, path.substr(pos, end - pos));
     }
+    pos = end + 1;
   }
-  // if a user tries to go over MAXPRIME
-  return MAXPRIME;
-}
\ No newline at end of file
+  return dir;
+}
+
+// Name: splitPath
+// Desc: Splits a path into its directory and its last name. Parameters:
+//    - path: the path of a file or directory
+//    - name: set to the last name of the path
+// Postconditions:
+//    - Returns the number of the directory that holds the last name, or -1 if
+//    that directory does not exist or the path has no name (the root).
+int DirTree::splitPath(string_view path, string_view &name) const {
+  while (!path.empty() && path.back() == '/') {
+    path.remove_suffix(1);
+  }
+  size_t slash = path.rfind('/');
+  if (slash == string_view::npos) {
+    name = path;
+    path = string_view();
+  } else {
+    name = path.substr(slash + 1);
+    path = path.substr(0, slash);
+  }
+  if (name.empty()) {
+    return -1;
+  }
+  return findDir(path);
+}
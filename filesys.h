@@ -9,24 +9,116 @@
 #ifndef FILESYS_H
 #define FILESYS_H
 #include "math.h"
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 using namespace std;
 const int DISKMIN = 100000;
 const int DISKMAX = 999999;
-const int MINPRIME = 101;                // Min size for hash table
-const int MAXPRIME = 99991;              // Max size for hash table
+const size_t MINPRIME = 101;             // Min size for hash table
+const size_t NOINDEX = (size_t)-1;       // index of a file not in a table
 typedef unsigned int (*hash_fn)(string); // declaration of hash function
+typedef unsigned int (*view_hash_fn)(string_view); // hash without a name copy
+typedef pair<string_view, int> FileKey; // the name and block of a lookup
 enum prob_t {
   QUADRATIC,
   DOUBLEHASH,
-  LINEAR
+  LINEAR,
+  SWISS,
+  ROBINHOOD,
+  CUCKOO,
+  HOPSCOTCH
 }; // types of collision handling policy
 #define DEFPOLCY QUADRATIC
+// PRIMECAP tables have prime capacities and reduce hashes with a precomputed
+// fast modulus, POW2CAP tables have power of two capacities and use a mask
+enum cap_t { PRIMECAP, POW2CAP }; // capacity mode of the hash tables
+// FILESTORE keeps one slot per file. GROUPSTORE keeps one slot per name, the
+// slot refers to a sorted group of all the blocks stored under the name.
+enum store_t { FILESTORE, GROUPSTORE }; // storage mode of the hash tables
+// The budget of one migration step: a quarter of the old table, a number of
+// scanned slots, a number of moved files, or a number of nanoseconds.
+enum step_t { QUARTERSTEP, SLOTSTEP, MOVESTEP, TIMESTEP }; // migration step budget
+const size_t TIMECHECK = 16; // slots a TIMESTEP step scans between clock reads
+// A capacity of a table and the fast modulus constant of that capacity. The
+// prime capacities come from a table that is generated at compile time, each
+// prime is about 1/PRIMEGROWTH larger than the one before it.
+struct TableCap {
+  size_t m_cap = 0;
+  uint64_t m_magic = 0;
+};
+const int PRIMEGROWTH = 8;      // growth step between prime capacities
+const int NUMPRIMECAPS = 327;   // prime capacities from MINPRIME to 2^62
+// The fast modulus constant of a capacity, ceil(2^64 / cap), or 0 if cap does
+// not fit in 32 bits and every hash value is its own remainder.
+constexpr uint64_t modMagic(size_t cap) {
+  return (cap > UINT32_MAX) ? 0 : UINT64_MAX / cap + 1;
+}
+// Every table keeps one control byte per slot next to the slot array. The
+// byte is CTRL_EMPTY, CTRL_DELETED or, for a live slot, a 7 bit tag taken from
+// the hash of the file, so most probes are rejected without reading the slot.
+const unsigned char CTRL_EMPTY = 0x80;   // bucket was never used
+const unsigned char CTRL_DELETED = 0xFE; // lazy deleted bucket
+const int GROUPWIDTH = 16; // control bytes the SWISS policy matches at once
+// A CUCKOO table is split into buckets of CUCKOOWAYS slots, the last
+// CUCKOOSTASH slots are the stash for files that found no room in a bucket.
+// Both buckets come from the user hash and the block, so files that share
+// them are never split by a rehash: a table holds at most
+// 2 * CUCKOOWAYS + CUCKOOSTASH of them and refuses the rest.
+const int CUCKOOWAYS = 4;      // slots per bucket
+const int CUCKOOSTASH = 4;     // stash slots at the end of the table
+const int CUCKOOMAXKICKS = 32; // evictions before a walk counts as a cycle
+// A HOPSCOTCH file stays within HOPRANGE slots of its home bucket, the home
+// bucket keeps a bitmap of the slots that hold its files. Files with the same
+// user hash and block share their home at every capacity, a table holds at
+// most HOPRANGE of them and refuses the rest.
+const int HOPRANGE = 32;         // neighborhood size, one bit per slot
+const float HOPMAXLOAD = 0.8;    // load factor limit of a HOPSCOTCH table
+const float MAXLOAD = 0.5;       // load factor limit of the other policies
+// The block allocator keeps one bit per block of [DISKMIN, DISKMAX], a set bit
+// is a block that some file is stored under. A second bitmap marks the full
+// words of the first one, so a search skips 64 * 64 used blocks at a time.
+const int NUMBLOCKS = DISKMAX - DISKMIN + 1;      // blocks of the disk
+const size_t BLOCKWORDS = (NUMBLOCKS + 63) / 64;  // words of the block bitmap
+const size_t FULLWORDS = (BLOCKWORDS + 63) / 64;  // words of the full bitmap
+const int TREEFANOUT = 32; // keys of a node of the ordered name index
+const int FINDAHEAD = 8;   // findFiles prefetches this many files ahead
+// The textbook string hash, val = val * 33 + c, as a hasher functor. A
+// FileSys built with a functor hashes a string_view of the name, so the name
+// is not copied and the body of the hash is inlined.
+struct TextbookHash {
+  unsigned int operator()(string_view str) const {
+    unsigned int val = 0;
+    for (char c : str)
+      val = val * 33 + c;
+    return val;
+  }
+};
+// An entry of the name index of a FileSys, the hash of a name and one block
+// stored under that name. The names themselves are not kept, a block of 0
+// marks an empty entry. m_slot is where the file was stored when the entry
+// was last written, findAll reads the file there instead of probing for it.
+struct NameEntry {
+  unsigned int m_hash = 0;
+  int m_block = 0;
+  unsigned int m_slot = 0; // slot of the file, a hint that may be stale
+};
+// An entry of the block index of a FileSys, one per block in
+// [DISKMIN, DISKMAX]. Usually a block has one owner and m_hashSum is the hash
+// of its name, the sum (modulo 2^32) lets a block with two owners give back
+// the hash of the other one when the first is removed.
+struct BlockOwner {
+  unsigned int m_hashSum = 0; // sum of the name hashes of the owners
+  unsigned int m_count = 0;   // number of files stored under the block
+};
 class Grader;
 class Tester;
 class FileSys;
+class DirTree;
 class File {
 public:
   friend class Grader;
@@ -37,7 +129,7 @@ public:
     m_diskBlock = diskBlock;
     m_used = used;
   }
-  string getName() const { return m_name; }
+  const string &getName() const { return m_name; }
   int getDiskBlock() const { return m_diskBlock; }
   bool getUsed() const { return m_used; }
   void setName(string name) { m_name = name; }
@@ -89,64 +181,459 @@ private:
   bool m_used;
 };
 
+// A bucket of the hash table. The name and disk block are stored inline in
+// the slot so that a table is one contiguous array and probing walks
+// sequential memory. Whether a slot is empty, deleted or live is kept in the
+// control byte array of its table. The slot also caches the value of the hash
+// function for its name, so a probe can reject a slot without comparing
+// names and a migration never hashes a name again.
+class Slot {
+public:
+  friend class Grader;
+  friend class Tester;
+  friend class FileSys;
+  Slot() : m_diskBlock(0), m_hash(0) {}
+  const string &getName() const { return m_name; }
+  int getDiskBlock() const { return m_diskBlock; }
+  unsigned int getHash() const { return m_hash; }
+
+private:
+  string m_name;       // the name of the stored file (the key)
+  int m_diskBlock;     // the disk block of the stored file, or its group
+  unsigned int m_hash; // the hash function result for m_name
+};
+
+// The ordered name index of a FileSys, a B+ tree of (name, block) keys in
+// ascending order of name and then block. The keys are kept in leaves of up to
+// TREEFANOUT keys that are linked in key order, so a scan walks arrays of keys
+// from one leaf to the next. A node that runs empty is freed, nodes are not
+// merged.
+class NameTree {
+public:
+  friend class Grader;
+  friend class Tester;
+  NameTree();
+  ~NameTree();
+  // adds a key, false if it is already there
+  bool insert(string_view name, int block);
+  // removes a key, false if it is not there
+  bool erase(string_view name, int block);
+  // number of keys
+  size_t size() const { return m_size; }
+  // calls visit(name, block) for every key whose name starts with prefix, in
+  // ascending order
+  template <class Visit> void scanPrefix(string_view prefix, Visit visit) const {
+    int pos;
+    for (const Node *leaf = lowerBound(prefix, pos); leaf != nullptr;
+         leaf = leaf->m_next, pos = 0) {
+      for (; pos < leaf->m_count; pos++) {
+        if (leaf->m_names[pos].compare(0, prefix.size(), prefix) != 0)
+          return;
+        visit(leaf->m_names[pos], leaf->m_blocks[pos]);
+      }
+    }
+  }
+
+private:
+  // A leaf holds m_count keys. An inner node holds m_count children, key i is
+  // the smallest key below child i.
+  struct Node {
+    bool m_leaf = true;
+    int m_count = 0;
+    string m_names[TREEFANOUT];
+    int m_blocks[TREEFANOUT];
+    Node *m_children[TREEFANOUT];
+    Node *m_prev = nullptr; // leaves only, the neighbors in key order
+    Node *m_next = nullptr;
+  };
+
+  Node *m_root;  // the root, a leaf while the tree fits in one node
+  size_t m_size; // number of keys
+
+  // private helper functions
+  static int compareKey(string_view name, int block, const Node *node, int pos); //order of a key and the key at pos
+  static int lowerPos(const Node *node, string_view name, int block); //first position of a leaf not below a key
+  static int childFor(const Node *node, string_view name, int block); //child of an inner node a key belongs to
+  const Node *lowerBound(string_view prefix, int &pos) const; //leaf and position of the first name not below prefix
+  Node *insertInto(Node *node, string_view name, int block, bool &added); //adds a key below node, returns a new right sibling if node split
+  bool eraseFrom(Node *node, string_view name, int block, bool &removed); //removes a key below node, true if node is empty now
+  static Node *addKey(Node *node, int pos, string_view name, int block, Node *child); //puts a key at pos, splits a full node
+  static void takeKey(Node *node, int pos); //removes the key at pos
+  static void moveKey(Node *from, int fromPos, Node *to, int toPos); //moves one key or child between nodes
+  static void freeNode(Node *node); //deletes a subtree
+};
+
 class FileSys {
 public:
   friend class Grader;
   friend class Tester;
-  FileSys(int size, hash_fn hash, prob_t probing);
+  friend class DirTree;
+  FileSys(size_t size, hash_fn hash, prob_t probing, cap_t capMode = PRIMECAP,
+          store_t storeMode = FILESTORE);
+  FileSys(size_t size, view_hash_fn hash, prob_t probing = DEFPOLCY,
+          cap_t capMode = PRIMECAP, store_t storeMode = FILESTORE);
+  // a stateless hasher functor with operator()(string_view), like
+  // TextbookHash, is called through a function instantiated for its type
+  template <class Hasher,
+            class = decltype((unsigned int)Hasher()(string_view()))>
+  FileSys(size_t size, Hasher, prob_t probing = DEFPOLCY,
+          cap_t capMode = PRIMECAP, store_t storeMode = FILESTORE)
+      : FileSys(size, &callHasher<Hasher>, probing, capMode, storeMode) {}
   ~FileSys();
   // Returns Load factor of the new table
   float lambda() const;
   // Returns the ratio of deleted slots in the new table
   float deletedRatio() const;
   // insert only happens in the new table
-  bool insert(File file);
+  bool insert(const File &file);
+  // insert a file whose name can be moved into its slot
+  bool insert(File &&file);
+  // insert a file built from its name and block in place
+  bool emplace(string_view name, int block);
+  // insert many files after sizing the table once, returns the number stored
+  size_t bulkLoad(const vector<File> &files, bool byHome = true);
+  // bulkLoad that moves the names of the files into their slots
+  size_t bulkLoad(vector<File> &&files, bool byHome = true);
+  // insert a batch with one rehash check, returns the number stored
+  size_t insertBatch(const vector<File> &files);
   // remove can happen from either table
-  bool remove(File file);
+  bool remove(const File &file);
+  // remove a batch with one rehash check, returns the number removed
+  size_t removeBatch(const vector<File> &files);
   // find can happen in either table
-  const File getFile(string name, int block) const;
+  const File getFile(const string &name, int block) const;
+  // find without copying the name, nullptr if the file is not stored
+  const Slot *findFile(string_view name, int block) const;
+  // findFile for every file of files, the loads of the lookups overlap
+  size_t findFiles(const FileKey *keys, size_t count, const Slot **found) const;
+  size_t findFiles(const vector<File> &files, vector<const Slot *> &found) const;
+  // every block that a file with this name is stored under
+  vector<int> findAll(string_view name) const;
+  // the file stored under a block, if the block has exactly one owner
+  const File getFileByBlock(int block) const;
+  // number of files stored under a block
+  int blockOwners(int block) const;
+  // insert a file under a free block, returns the block or 0 if none is free
+  int create(string_view name);
+  // number of blocks no file is stored under
+  size_t freeBlocks() const;
+  // 0 if the free blocks are one run, close to 1 if they are scattered
+  float fragmentation() const;
+  // builds the ordered name index and keeps it up to date from now on
+  void enableOrderedIndex();
+  // calls visit(name, block) for every file whose name starts with prefix, in
+  // ascending order of name and block
+  template <class Visit> void scanPrefix(string_view prefix, Visit visit) const {
+    if (m_ordered != nullptr) {
+      m_ordered->scanPrefix(prefix, visit);
+      return;
+    }
+    // without the index the matching files are collected and sorted
+    vector<File> files;
+    collectPrefix(prefix, files);
+    for (const File &file : files)
+      visit(file.getName(), file.getDiskBlock());
+  }
+  // calls visit(name, block) for every stored file, in no particular order,
+  // visit must not change the table
+  template <class Visit> void forEach(Visit visit) const {
+    visitSlots([&](const Slot &slot) {
+      if (m_storeMode == GROUPSTORE) {
+        for (int block : m_groups[slot.m_diskBlock])
+          visit(slot.m_name, block);
+      } else {
+        visit(slot.m_name, slot.m_diskBlock);
+      }
+    });
+  }
+  // iterates over the stored files, the table may change between steps
+  class LiveIterator;
+  LiveIterator begin() const;
+  LiveIterator end() const;
+  // bound the work of a migration step, amount is in slots, files or ns
+  void setMigrationStep(step_t mode, size_t amount = 0);
+  // grow the table so n files (names in GROUPSTORE) fit under the load limit
+  bool reserve(size_t n, bool now = false);
+  // rehash the table to the smallest capacity that fits the stored files
+  bool shrink_to_fit(bool now = false);
   // update the information
-  bool updateDiskBlock(File file, int block);
+  bool updateDiskBlock(const File &file, int block);
   void changeProbPolicy(prob_t policy);
   void dump() const;
 
 private:
-  hash_fn m_hash;     // hash function
+  hash_fn m_hash;     // hash function taking a string, or nullptr
+  view_hash_fn m_viewHash; // hash function taking a string_view, or nullptr
   prob_t m_newPolicy; // stores the change of policy request
+  cap_t m_capMode;    // prime or power of two capacities
+  store_t m_storeMode; // one slot per file or one slot per name
 
-  File **m_currentTable; // hash table
-  int m_currentCap;      // hash table size (capacity)
-  int m_currentSize;     // current number of entries
-                         // m_currentSize includes deleted entries
-  int m_currNumDeleted;  // number of deleted entries
+  // In GROUPSTORE the block of a slot is the number of its group in m_groups
+  // and the slot is keyed by its name alone: m_keyMask is 0 and every block
+  // is masked before it is hashed or compared. In FILESTORE it is ~0. A
+  // CUCKOO or HOPSCOTCH table then places a slot by the name hash alone, and
+  // its limit on files of one hash and block holds for names of one hash.
+  int m_keyMask;
+  vector<vector<int>> m_groups; // sorted blocks of each name (GROUPSTORE)
+  vector<int> m_freeGroups;     // numbers of unused groups
+
+  Slot *m_currentTable; // hash table
+  unsigned char *m_currCtrl; // control bytes of the hash table
+  unsigned int *m_currHop;   // neighborhood bitmaps, HOPSCOTCH only
+  uint64_t m_currMagic;      // fast modulus constant of m_currentCap
+  size_t m_currentCap;      // hash table size (capacity)
+  size_t m_currentSize;     // current number of live entries
+                            // deleted entries are in m_currNumDeleted
+  size_t m_currNumDeleted;  // number of deleted entries
   prob_t m_currProbing;  // collision handling policy
 
-  File **m_oldTable;   // hash table
-  int m_oldCap;        // hash table size (capacity)
-  int m_oldSize;       // current number of entries
-                       // m_oldSize includes deleted entries
-  int m_oldNumDeleted; // number of deleted entries
+  Slot *m_oldTable;    // hash table
+  unsigned char *m_oldCtrl; // control bytes of the hash table
+  unsigned int *m_oldHop;   // neighborhood bitmaps, HOPSCOTCH only
+  uint64_t m_oldMagic;      // fast modulus constant of m_oldCap
+  size_t m_oldCap;        // hash table size (capacity)
+  size_t m_oldSize;       // current number of live entries
+                          // deleted entries are in m_oldNumDeleted
+  size_t m_oldNumDeleted; // number of deleted entries
   prob_t m_oldProbing; // collision handling policy
 
-  int m_transferIndex; // this can be used as a temporary place holder
+  size_t m_transferIndex; // this can be used as a temporary place holder
                        // during incremental transfer to scanning the table
+  step_t m_stepMode;   // budget of a migration step
+  size_t m_stepAmount; // slots, files or nanoseconds of a step
+
+  // The name index groups the blocks of every name hash by linear probing in
+  // a power of two table, findAll reads one run of it. It is independent of
+  // the file tables, so migrations and policy changes do not touch it.
+  NameEntry *m_names;   // name index entries
+  size_t m_namesCap;    // capacity of the name index, a power of two
+  size_t m_namesSize;   // number of used entries
+
+  // The block index holds an entry for every block of the disk, it is
+  // indexed by block - DISKMIN. Hash values and blocks do not change when
+  // files move, so migrations do not touch it either. It is nullptr until
+  // the first block lookup or allocation builds it.
+  mutable BlockOwner *m_owners;
+
+  // The allocator bitmaps follow the block index, a block is used while it
+  // has an owner. create searches from the word of the last allocation.
+  mutable uint64_t *m_usedBlocks; // one bit per block, set if the block is used
+  mutable uint64_t *m_fullWords;  // one bit per word of m_usedBlocks, set if full
+  mutable size_t m_numUsedBlocks; // number of set bits in m_usedBlocks
+  size_t m_allocWord;     // word of m_usedBlocks the next search starts at
+
+  NameTree *m_ordered; // the ordered name index, or nullptr if not enabled
+
+  // The migration waits while a LiveIterator walks the tables, so no file
+  // moves from the old table to the current one under it
+  mutable size_t m_iterators; // number of unfinished LiveIterators
 
   // private helper functions
-  bool isPrime(int number);
-  int findNextPrime(int current);
+  template <class Hasher> static unsigned int callHasher(string_view name) {
+    return Hasher()(name);
+  }
+  // calls visit with every live slot of both tables
+  template <class Visit> void visitSlots(Visit visit) const {
+    for (int table = 1; table <= 2; table++) {
+      const Slot *slots = (table == 1) ? m_currentTable : m_oldTable;
+      const unsigned char *ctrl = (table == 1) ? m_currCtrl : m_oldCtrl;
+      size_t cap = (table == 1) ? m_currentCap : m_oldCap;
+      for (size_t i = 0; slots != nullptr && i < cap; i++) {
+        i = nextLive(ctrl, i, cap);
+        if (i < cap)
+          visit(slots[i]);
+      }
+    }
+  }
+  unsigned int hashName(string_view name) const; //hash with the hasher of the table
+  bool isNewFile(string_view name, int block, unsigned int hashVal) const; //valid block and not in either table
+  bool addFile(string &name, int block, unsigned int hashVal); //stores a new file and checks the load factor
+  bool addBlock(string_view name, int block, unsigned int hashVal); //adds a block to the group of a stored name
+  void insertStep(); //rehash check and migration step after an insert
+  bool removeFile(const File &file, unsigned int hashVal); //deletes a file without the rehash check
+  void removeStep(); //rehash check and migration step after a remove
+  size_t newSlots(const vector<unsigned int> &hashes) const; //slots a batch of new files takes at most
+  bool addNew(const File &file, unsigned int hashVal); //stores a new file with a copy of its name
+  bool addNew(File &file, unsigned int hashVal); //stores a new file and moves its name
+  template <class Batch>
+  size_t loadBatch(Batch &files, bool byHome); //bulkLoad for a const or a movable batch
+  template <class Batch>
+  size_t storeBatch(Batch &files, const vector<unsigned int> &hashes, bool byHome, bool stepEach); //stores the new files of a batch without the rehash check
+  void homeOrder(const vector<File> &files, const vector<unsigned int> &hashes, vector<size_t> &order) const; //batch positions sorted by home bucket
+  bool indexedFile(const NameEntry &entry, string_view name) const; //whether a name index entry is a file with the name
+  size_t nameHome(unsigned int hashVal) const; //home entry of a name hash in the name index
+  int keyBlock(const Slot &slot) const { return slot.m_diskBlock & m_keyMask; } //block of the key of a slot
+  const Slot *findName(string_view name, unsigned int hashVal) const; //slot of a name in GROUPSTORE
+  int newGroup(int block); //group holding one block
+  void freeGroup(int group); //returns a group for reuse
+  void nameIndexAdd(unsigned int hashVal, int block, size_t slot); //adds a block to the name index
+  void nameIndexMove(unsigned int hashVal, int block, size_t slot); //updates the slot hint of a block in the name index
+  void nameIndexGrow(size_t cap); //rebuilds the name index with a new capacity
+  void nameIndexRemove(unsigned int hashVal, int block); //removes a block from the name index
+  void buildBlockIndex() const; //allocates and fills the block index on first use
+  void ownBlock(unsigned int hashVal, int block) const; //adds an owner to the block index
+  void releaseBlock(unsigned int hashVal, int block); //removes an owner from the block index
+  int findFreeBlock(); //first free block from m_allocWord on, or 0
+  void fileAdded(string_view name, unsigned int hashVal, int block); //updates the indexes for a stored file
+  void fileRemoved(string_view name, unsigned int hashVal, int block); //updates the indexes for a removed file
+  void collectPrefix(string_view prefix, vector<File> &files) const; //sorted files of a prefix without the ordered index
+  void markBlock(int block, bool used) const; //sets the bit of a block in the allocator
+  bool isPrime(size_t number);
+  size_t findNextPrime(size_t current);
+  static TableCap primeCapAtLeast(size_t size); //table prime capacity lookup
 
   /******************************************
    * Private function declarations go here! *
    ******************************************/
-  int linearProbing(int index, int m_currentCap) const ; //linear probing policy helper
-  int quadraticProbing(int index, int jump,int m_currentCap)const ; // helper function for quadratic probing
-  int doubleHashing(int hashVal, int iteration, int cap) const ; //helper function for double hash probing
-  void transferData(); //helper function to help with transfering data from old table to new table
-  void transferEntry(int transferIndex); //helper function to tranfer live data
-  void rehash(int cap); //helper function to rehash table
-  int getNumData() const ; //helper function to calculate # of useable data in table 
-  int getNextIndex(int index, int originalIndex, int &step, int cap, int hashVal, int table) const; //helper function to probe
+  size_t linearProbing(size_t index, size_t cap) const ; //linear probing policy helper
+  size_t quadraticProbing(size_t index, size_t jump, size_t cap) const ; // helper function for quadratic probing
+  size_t doubleHashing(size_t index, size_t hashVal, size_t cap) const ; //helper function for double hash probing
+  size_t homeIndex(unsigned int value, int table) const; //reduces a hash to a slot index without a division
+  static size_t fastMod(unsigned int value, uint64_t magic, size_t cap); //value % cap from the fast modulus constant
+  static size_t nextPowerOfTwo(size_t current); //smallest power of two capacity not below current
+  void transferData(bool whole = false); //helper function to help with transfering data from old table to new table
+  size_t minTransfer() const; //slots a step scans at least so the migration ends in time
+  bool transferEntry(size_t transferIndex); //helper function to tranfer live data
+  void rehash(TableCap newCap); //helper function to rehash table
+  size_t getNumData() const ; //helper function to calculate # of useable data in table 
+  float maxLoad() const; //load factor limit of the current policy
+  TableCap growCap(); //capacity of the table a rehash creates
+  TableCap capFor(size_t live) const; //capacity of a new table for live entries
+  TableCap fitCap(size_t live) const; //smallest capacity that holds live entries under the load limit
+  bool resize(TableCap newCap, bool now); //rehashes to a capacity after the running migration
+  bool finishMigration(); //moves the files left in the old table at once
+  size_t homeBucket(unsigned int hashVal, int block, int table) const; //first bucket a file probes in a table
+  void prefetchHome(unsigned int hashVal, int block) const; //starts loading the home buckets of a file in both tables
+  void prefetchName(unsigned int hashVal, int block) const; //starts loading the name in the home slot of a file
+  const Slot *findHashed(string_view name, int block, unsigned int hashVal) const; //findFile with the hash of the name
+  size_t getNextIndex(size_t index, size_t &step, size_t cap, size_t hashVal, int table) const; //helper function to probe
+  size_t findIndex(string_view name, int block, unsigned int hashVal, int table) const; //helper function to find a live file in a table
+  size_t findFreeIndex(unsigned int hashVal, int block) const; //helper function to find an insert slot in the current table
+  template <prob_t Policy>
+  size_t nextProbe(size_t index, size_t jump, size_t cap, size_t hashVal) const; //probe step of a policy chosen at compile time
+  template <prob_t Policy>
+  size_t probeFindIndex(string_view name, int block, unsigned int hashVal, int table) const; //lookup loop specialized per policy
+  template <prob_t Policy>
+  size_t probeFreeIndex(unsigned int hashVal) const; //insert slot loop specialized per policy
+  size_t storeFile(string &name, int block, unsigned int hashVal); //helper function to place a file in the current table
+  size_t placeFile(string &name, int block, unsigned int hashVal); //storeFile with the CUCKOO cycle fallback
+  void fillSlot(size_t index, string &name, int block, unsigned int hashVal); //helper function to write a file into a current table slot
+  size_t swissFindIndex(string_view name, int block, unsigned int hashVal, int table) const; //SWISS policy lookup by control byte groups
+  size_t swissFreeIndex(unsigned int mixed) const; //SWISS policy insert slot by control byte groups
+  static unsigned int mixHash(unsigned int hashVal, int block); //helper function to mix the name hash with the block
+  static unsigned int matchGroup(const unsigned char *group, unsigned char value); //bit mask of group bytes equal to value
+  static unsigned int matchFree(const unsigned char *group); //bit mask of empty or deleted group bytes
+  static size_t nextLive(const unsigned char *ctrl, size_t index, size_t cap); //first live slot from index on, skipping free groups
+  static unsigned char *allocCtrl(size_t cap); //helper function to allocate empty control bytes
+  void setCtrl(size_t index, unsigned char value, int table); //helper function to write a control byte
+  void dumpSlot(size_t index, int table) const; //helper function to print one bucket
+  void eraseSlot(size_t index, int table); //helper function to delete a file from its bucket
+  size_t probeDistance(size_t index, int table) const; //distance of a slot from its home bucket
+  size_t robinHoodFindIndex(string_view name, int block, unsigned int hashVal, int table) const; //ROBINHOOD policy lookup with early exit
+  size_t robinHoodStore(string &name, int block, unsigned int hashVal); //ROBINHOOD policy insert
+  void robinHoodErase(size_t index); //ROBINHOOD policy backward shift delete
+  static void cuckooBuckets(unsigned int hashVal, int block, size_t cap, size_t &first, size_t &second); //the two buckets of a file
+  size_t cuckooFindIndex(string_view name, int block, unsigned int hashVal, int table) const; //CUCKOO policy lookup in two buckets and the stash
+  size_t cuckooFreeSlot(size_t start, size_t count) const; //first free slot of a bucket or the stash
+  size_t cuckooStore(string &name, int block, unsigned int hashVal); //CUCKOO policy insert with displacement
+  bool growTable(); //starts a rehash when a file finds no slot
+  static unsigned int *allocHop(size_t cap, prob_t probing); //helper function to allocate the neighborhood bitmaps
+  size_t hopscotchFindIndex(string_view name, int block, unsigned int hashVal, int table) const; //HOPSCOTCH policy lookup by bitmap
+  size_t hopscotchStore(string &name, int block, unsigned int hashVal); //HOPSCOTCH policy insert
+  void hopscotchErase(size_t index); //HOPSCOTCH policy delete in the current table
   void cleanUpOldTable(); //helper function to delete m_oldTable
 };
 
+// Walks the live files of a FileSys, the old table first and then the current
+// one, and skips a group of free slots with one control byte match. Files can
+// be inserted and removed between steps: the migration waits until the walk
+// ends, so every file stored for the whole walk is visited exactly once, and
+// a file inserted or removed during the walk may or may not be. A waiting
+// migration can not make room, so once the files of both tables reach the
+// load limit of the current table an insert returns false until the walk
+// ends; a CUCKOO or HOPSCOTCH insert that finds no slot fails as well.
+// ROBINHOOD, CUCKOO and HOPSCOTCH tables also move files within a table on
+// insert and remove, for them that guarantee only holds without changes.
+class FileSys::LiveIterator {
+public:
+  friend class Grader;
+  friend class Tester;
+  friend class FileSys;
+  LiveIterator(const LiveIterator &other);
+  LiveIterator &operator=(const LiveIterator &other);
+  ~LiveIterator();
+  LiveIterator &operator++();
+  // a copy of the file, getName does not copy the name
+  const File operator*() const;
+  const string &getName() const;
+  int getDiskBlock() const;
+  bool operator==(const LiveIterator &other) const;
+  bool operator!=(const LiveIterator &other) const { return !(*this == other); }
+
+private:
+  const FileSys *m_filesys; // the table, nullptr once the walk ended
+  const Slot *m_slots[2];           // the tables to walk, in order
+  const unsigned char *m_ctrl[2];   // their control bytes
+  size_t m_cap[2];                  // their capacities, 0 if not used
+  int m_table;    // the table of the file, 2 once the walk ended
+  size_t m_index; // the slot of the file
+  int m_block;    // the block of the file in a GROUPSTORE group
+
+  LiveIterator(const FileSys *filesys); //first file of filesys, or the end for nullptr
+  void settle(); //moves to the first file from the position on
+  void release(); //ends the walk and lets the migration go on
+};
+
+// A directory tree on top of FileSys. Every directory keeps its own FileSys
+// for its files and one for its subdirectories, both keyed by the name of the
+// entry within the directory, so a path is resolved one component at a time
+// and a directory is listed from its own tables. A subdirectory is stored
+// under the block DISKMIN + its number in m_dirs. Renaming a directory moves
+// one entry, the tables below it do not change. The tables are GROUPSTORE,
+// with CUCKOO or HOPSCOTCH a directory refuses names past the limit on names
+// of one hash.
+class DirTree {
+public:
+  friend class Grader;
+  friend class Tester;
+  DirTree(hash_fn hash, prob_t probing = DEFPOLCY);
+  DirTree(view_hash_fn hash, prob_t probing = DEFPOLCY);
+  template <class Hasher,
+            class = decltype((unsigned int)Hasher()(string_view()))>
+  DirTree(Hasher, prob_t probing = DEFPOLCY)
+      : DirTree(&FileSys::callHasher<Hasher>, probing) {}
+  ~DirTree();
+  // creates a directory, its parent must exist
+  bool mkdir(string_view path);
+  // stores a file in an existing directory
+  bool insert(string_view path, int block);
+  bool remove(string_view path, int block);
+  // the slot of a file, nullptr if it is not stored
+  const Slot *findFile(string_view path, int block) const;
+  // the names in a directory, subdirectories end with '/'
+  vector<string> list(string_view path) const;
+  // moves a directory or all the files of a name to a new path
+  bool rename(string_view from, string_view to);
+
+private:
+  // A directory, the tables are created with the directory
+  struct Dir {
+    FileSys *m_files = nullptr;   // files of the directory (GROUPSTORE)
+    FileSys *m_subdirs = nullptr; // subdirectories, by their number
+    int m_parent = -1;            // number of the parent directory
+  };
+
+  hash_fn m_hash;          // hash function of the tables, or nullptr
+  view_hash_fn m_viewHash; // hash function taking a string_view, or nullptr
+  prob_t m_probing;        // collision handling policy of the tables
+  vector<Dir> m_dirs;      // the directories, the root is number 0
+
+  // private helper functions
+  int newDir(int parent); //creates the tables of a directory
+  int childDir(int dir, string_view name) const; //number of a subdirectory, or -1
+  bool hasFiles(int dir, string_view name) const; //a file of dir has the name
+  int findDir(string_view path) const; //number of the directory of a path, or -1
+  int splitPath(string_view path, string_view &name) const; //directory and last name of a path
+};
+
 #endif
\ No newline at end of file
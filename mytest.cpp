@@ -8,7 +8,10 @@
  **********************************************************/
 #include "filesys.h"
 #include <algorithm>
+#include <cstdlib>
+#include <map>
 #include <math.h>
+#include <new>
 #include <random>
 #include <vector>
 
@@ -147,6 +150,33 @@ unsigned int hashCode(const string str) {
     val = val * thirtyThree + str[i];
   return val;
 }
+
+int allocCalls = 0; // number of heap allocations of the test program
+// the global allocation functions are replaced so a test can count the heap
+// allocations of a piece of code
+void *operator new(size_t size) {
+  allocCalls++;
+  void *ptr = malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr)
+    throw bad_alloc();
+  return ptr;
+}
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+int hashCalls = 0; // number of calls to countingHash
+// the same hash as hashCode, it also counts how often a name is hashed
+unsigned int countingHash(const string str) {
+  hashCalls++;
+  return hashCode(str);
+}
+// the same hash as hashCode for a string_view, it counts its calls too
+unsigned int viewHash(string_view str) {
+  hashCalls++;
+  return TextbookHash()(str);
+}
+// every name gets the same hash, files then only differ by their block
+unsigned int sameHash(const string str) { return 7; }
 enum DataSetType { NAMES_DB, NON_COLLIDE, COLLIDE };
 
 class Tester {
@@ -155,19 +185,21 @@ public:
                           prob_t probing, DataSetType dataSetType);
   bool verifyFilePlacement(const FileSys &newSys, const vector<File> &fileList,
                            prob_t method);
-  int countLiveData(File **arr, int size);
+  int countLiveData(const unsigned char *ctrl, int size);
   int verifyGetNextIndex(int probeIndex, int expectedIndex, int &jump,
                          int fileCap, int hashVal, int table,
                          prob_t method) const;
   bool verifyData(const FileSys &filesys) const;
-  bool checkTable(File **table, int tableCap, const File &fileInSys,
-                  int genHash, int tableType, prob_t probing);
+  bool checkTable(Slot *table, const unsigned char *ctrl, int tableCap,
+                  const File &fileInSys, int genHash, int tableType,
+                  prob_t probing);
   bool isFileInCurrentOrOldTable(const FileSys &newSys, const File &fileInSys,
                                  prob_t probing);
   int verifyIndex(int probeIndex, int originalIndex, const int fileCap,
                   int hashVal, int tableNumber, prob_t method,
                   const FileSys &filesys) const;
-  bool checkFileAtHash(File **table, const File &fileInSys, int hash, int cap);
+  bool checkFileAtHash(Slot *table, const unsigned char *ctrl,
+                       const File &fileInSys, int hash, int cap);
   bool testforNormalNonCollide(int filesysSize, int numdataPoints, hash_fn hash,
                                prob_t probing, DataSetType dataSetType);
 
@@ -200,6 +232,53 @@ public:
   bool testmidRehashDeletion(int filesysSize, int numdataPoints, hash_fn hash,
                              prob_t probing, DataSetType dataSetType,
                              int removals);
+  bool verifyControlBytes(const unsigned char *ctrl, Slot *table, int cap,
+                          hash_fn hash);
+  bool testSwissControlBytes(int filesysSize, int numdataPoints, hash_fn hash,
+                             DataSetType dataSetType, int removals);
+  bool testHashOncePerInsert(int numdataPoints, prob_t probing);
+  bool testUpdateDiskBlock(int filesysSize, int numdataPoints, hash_fn hash,
+                           prob_t probing, DataSetType dataSetType);
+  bool testRobinHoodRemoval(int filesysSize, int numdataPoints, hash_fn hash,
+                            DataSetType dataSetType, int rounds);
+  bool verifyCuckooPlacement(Slot *table, const unsigned char *ctrl,
+                             size_t cap);
+  bool testCuckooPlacement(int filesysSize, int numdataPoints, hash_fn hash,
+                           DataSetType dataSetType, int removals);
+  bool testCuckooCycle();
+  bool testEqualHash(prob_t probing, store_t storeMode, int ceiling);
+  bool verifyHopBitmaps(const FileSys &filesys);
+  bool testHopscotch(int filesysSize, int numdataPoints, hash_fn hash,
+                     DataSetType dataSetType, int removals);
+  bool testLargeCapacity(int numdataPoints, prob_t probing);
+  bool testPowerOfTwoCapacity(int numdataPoints, prob_t probing);
+  bool testFastModulus();
+  bool testPrimeCapacities();
+  bool testHasherFunctor(int numdataPoints, prob_t probing);
+  bool testZeroCopyLookup(int numdataPoints, prob_t probing);
+  bool testMoveInsert(int numdataPoints, prob_t probing);
+  bool testFindAll(int filesysSize, int numdataPoints, hash_fn hash,
+                   prob_t probing, int removals);
+  bool testGroupedStore(int filesysSize, int numdataPoints, int numNames,
+                        prob_t probing);
+  bool testBlockIndex(int filesysSize, int numdataPoints, hash_fn hash,
+                      prob_t probing, store_t storeMode);
+  bool testBlockAllocator(int numdataPoints, prob_t probing);
+  bool testDirTree(int numdataPoints, prob_t probing);
+  bool testDirTreeFull(prob_t probing);
+  bool testOrderedIndex(int numdataPoints, prob_t probing, store_t storeMode);
+  bool testLiveIterator(int numdataPoints, prob_t probing, store_t storeMode);
+  bool testWalkInserts(int numdataPoints, prob_t probing, store_t storeMode);
+  bool testWalkBatch(int numdataPoints, prob_t probing, store_t storeMode,
+                     bool bulk);
+  bool testBulkLoad(int numdataPoints, prob_t probing, store_t storeMode);
+  bool testFindFiles(int numdataPoints, prob_t probing, store_t storeMode);
+  bool testBatches(int numdataPoints, prob_t probing, store_t storeMode);
+  bool testReserve(int numdataPoints, prob_t probing, bool now);
+  bool testBoundedFinish(int numdataPoints, prob_t probing, step_t mode,
+                         size_t amount);
+  bool testMigrationStep(int numdataPoints, prob_t probing, step_t mode,
+                         size_t amount);
 
 private:
   vector<File> m_dataList;
@@ -423,7 +502,7 @@ int Tester::verifyIndex(int probeIndex, int originalIndex, const int fileCap,
   int jump = 0; // Initialize jump counter to keep track of the number of probes
 
   // Loop until an empty slot is found or the maximum capacity is reached
-  while (filesys.m_currentTable[index] != nullptr && jump < fileCap) {
+  while (filesys.m_currCtrl[index] != CTRL_EMPTY && jump < fileCap) {
     // Get the next index to probe based on the current probing method
     index = verifyGetNextIndex(index, originalIndex, jump, fileCap, hashVal,
                                tableNumber, method);
@@ -505,15 +584,16 @@ bool Tester::isFileInCurrentOrOldTable(const FileSys &newSys,
   int genHash = hashCode(fileInSys.getName()) % newSys.m_currentCap;
 
   // Check if the file is in the current table
-  bool foundInCurrent = checkTable(newSys.m_currentTable, newSys.m_currentCap,
-                                   fileInSys, genHash, 1, probing);
+  bool foundInCurrent =
+      checkTable(newSys.m_currentTable, newSys.m_currCtrl, newSys.m_currentCap,
+                 fileInSys, genHash, 1, probing);
   if (foundInCurrent) {
     return true;
   }
 
   // Check if the file is in the old table
-  bool foundInOld = checkTable(newSys.m_oldTable, newSys.m_oldCap, fileInSys,
-                               genHash, 2, probing);
+  bool foundInOld = checkTable(newSys.m_oldTable, newSys.m_oldCtrl,
+                               newSys.m_oldCap, fileInSys, genHash, 2, probing);
   if (foundInOld) {
     return true;
   }
@@ -525,7 +605,8 @@ bool Tester::isFileInCurrentOrOldTable(const FileSys &newSys,
 // Name: checkTable
 // Desc: Checks if the specified file is present in the hash table using the
 // given probing method. Parameters:
-//    - table: a pointer to the hash table (array of File pointers).
+//    - table: a pointer to the hash table (array of slots).
+//    - ctrl: the control bytes of the hash table.
 //    - tableCap: the capacity of the hash table.
 //    - fileInSys: a constant reference to the File object to be checked.
 //    - genHash: the generated hash value for the file's name.
@@ -543,11 +624,12 @@ bool Tester::isFileInCurrentOrOldTable(const FileSys &newSys,
 //    probing method.
 //    - Returns false if the file is not found in the hash table after probing
 //    all possible slots.
-bool Tester::checkTable(File **table, int tableCap, const File &fileInSys,
-                        int genHash, int tableType, prob_t probing) {
+bool Tester::checkTable(Slot *table, const unsigned char *ctrl, int tableCap,
+                        const File &fileInSys, int genHash, int tableType,
+                        prob_t probing) {
 
   // Check if the file is at the initial hash index
-  if (checkFileAtHash(table, fileInSys, genHash, tableCap)) {
+  if (checkFileAtHash(table, ctrl, fileInSys, genHash, tableCap)) {
     return true;
   }
 
@@ -559,10 +641,10 @@ bool Tester::checkTable(File **table, int tableCap, const File &fileInSys,
     index = verifyGetNextIndex(index, genHash, i, tableCap, genHash, tableType,
                                probing);
 
-    // Check if the index is within bounds and the slot is not null
-    if (index >= 0 && index < tableCap && table[index]) {
+    // Check if the index is within bounds and the slot is not empty
+    if (index >= 0 && index < tableCap && ctrl[index] != CTRL_EMPTY) {
       // Check if the file is at the probed index
-      if (checkFileAtHash(table, fileInSys, index, tableCap)) {
+      if (checkFileAtHash(table, ctrl, fileInSys, index, tableCap)) {
         return true;
       }
     } else {
@@ -577,7 +659,8 @@ bool Tester::checkTable(File **table, int tableCap, const File &fileInSys,
 // Name: checkFileAtHash
 // Desc: Checks if the specified file is present at the given hash index in the
 // hash table. Parameters:
-//    - table: a pointer to the hash table (array of File pointers).
+//    - table: a pointer to the hash table (array of slots).
+//    - ctrl: the control bytes of the hash table.
 //    - fileInSys: a constant reference to the File object to be checked.
 //    - hash: the hash index to check in the hash table.
 //    - cap: the capacity of the hash table.
@@ -591,13 +674,12 @@ bool Tester::checkTable(File **table, int tableCap, const File &fileInSys,
 //    hash table.
 //    - Returns false if the file is not found at the specified hash index or
 //    the slot is empty.
-bool Tester::checkFileAtHash(File **table, const File &fileInSys, int hash,
-                             int cap) {
-  // Check if the hash index is within bounds and the slot is not null
-  if (hash >= 0 && hash < cap && table[hash]) {
-    File *filePtr =
-        table[hash]; // Get the pointer to the file at the hash index
-    const File &theFile = *filePtr; // Dereference the pointer to get the file
+bool Tester::checkFileAtHash(Slot *table, const unsigned char *ctrl,
+                             const File &fileInSys, int hash, int cap) {
+  // Check if the hash index is within bounds and the slot is not empty
+  if (hash >= 0 && hash < cap && ctrl[hash] != CTRL_EMPTY) {
+    // Get the slot at the hash index, the file is stored inline in it
+    const Slot &theFile = table[hash];
 
     // Check if the file's name and disk block match the given file
     bool nameMatches = theFile.getName() == fileInSys.getName();
@@ -650,7 +732,7 @@ bool Tester::testforNormalNonCollide(int filesysSize, int numdataPoints,
 
   // Count the number of live data points in the current table
   int liveDataCurrent =
-      countLiveData(newSys.m_currentTable, newSys.m_currentCap);
+      countLiveData(newSys.m_currCtrl, newSys.m_currentCap);
 
   // Compare the actual number of data points to the expected number
   int actualDataPoints = liveDataCurrent;
@@ -665,23 +747,24 @@ bool Tester::testforNormalNonCollide(int filesysSize, int numdataPoints,
 // Name: countLiveData
 // Desc: Counts the number of live (active) data points in the given hash table.
 // Parameters:
-//    - arr: a pointer to the hash table (array of File pointers).
+//    - ctrl: the control bytes of the hash table.
 //    - size: the capacity of the hash table.
 // Preconditions:
-//    - The hash table (arr) must be properly initialized and non-null.
+//    - The control bytes (ctrl) must be properly initialized and non-null.
 //    - The size parameter must represent the correct capacity of the hash
 //    table.
 // Postconditions:
 //    - Returns the number of live data points in the hash table, where a live
-//    data point is one that is non-null and marked as used.
+//    data point is one that is occupied and marked as used.
 
-int Tester::countLiveData(File **arr, int size) {
+int Tester::countLiveData(const unsigned char *ctrl, int size) {
   int count = 0; // Initialize the count of live data points
 
   // Iterate through each slot in the hash table
   for (int i = 0; i < size; ++i) {
-    // Check if the slot is non-null and the file at the slot is marked as used
-    if ((arr[i] != nullptr) && (arr[i]->getUsed() != false)) {
+    // A live slot has a tag in its control byte, empty and deleted slots have
+    // the high bit set
+    if ((ctrl[i] & 0x80) == 0) {
       count++; // Increment the count of live data points
     }
   }
@@ -772,7 +855,7 @@ bool Tester::testFindColllide(int filesysSize, int numdataPoints, hash_fn hash,
 
   // Count the number of live data points in the current table
   int liveDataCurrent =
-      countLiveData(newSys.m_currentTable, newSys.m_currentCap);
+      countLiveData(newSys.m_currCtrl, newSys.m_currentCap);
 
   // Compare the actual number of data points to the expected number
   int actualDataPoints = liveDataCurrent;
@@ -826,7 +909,7 @@ bool Tester::testFindNonCollide(int filesysSize, int numdataPoints,
 
   // Count the number of live data points in the current table
   int liveDataCurrent =
-      countLiveData(newSys.m_currentTable, newSys.m_currentCap);
+      countLiveData(newSys.m_currCtrl, newSys.m_currentCap);
 
   // Compare the actual number of data points to the expected number
   int actualDataPoints = liveDataCurrent;
@@ -911,7 +994,7 @@ bool Tester::testRemoveWithNonCollide(int filesysSize, int numdataPoints,
 
   // Count the number of live data points in the current table
   int liveDataCurrent =
-      countLiveData(newSys.m_currentTable, newSys.m_currentCap);
+      countLiveData(newSys.m_currCtrl, newSys.m_currentCap);
   int actualDataPoints = numdataPoints - numRemovals;
 
   // Compare the actual number of live data points to the expected number after
@@ -992,7 +1075,7 @@ bool Tester::testRemoveError(int filesysSize, int numdataPoints, hash_fn hash,
 
   // Count the number of live data points in the current table
   int liveDataCurrent =
-      countLiveData(newSys.m_currentTable, newSys.m_currentCap);
+      countLiveData(newSys.m_currCtrl, newSys.m_currentCap);
   int actualDataPoints = numdataPoints;
 
   // Compare the actual number of live data points to the expected number
@@ -1077,7 +1160,7 @@ bool Tester::testRemoveWithCollideNoRehash(int filesysSize, int numdataPoints,
 
   // Count the number of live data points in the current table
   int liveDataCurrent =
-      countLiveData(newSys.m_currentTable, newSys.m_currentCap);
+      countLiveData(newSys.m_currCtrl, newSys.m_currentCap);
   int actualDataPoints = numdataPoints - numRemovals;
 
   // Compare the actual number of live data points to the expected number after
@@ -1177,13 +1260,13 @@ bool Tester::testRehash(int filesysSize, int numdataPoints, hash_fn hash,
   }
 
   // Verify if rehashing has occurred by checking the new capacity
-  if (newSys.m_currentCap <= filesysSize) {
+  if (newSys.m_currentCap <= (size_t)filesysSize) {
     return false; // Return false if rehashing has not occurred
   }
 
   // Count the number of live data points in the current table
   int liveDataCurrent =
-      countLiveData(newSys.m_currentTable, newSys.m_currentCap);
+      countLiveData(newSys.m_currCtrl, newSys.m_currentCap);
 
   // Compare the actual number of data points to the expected number after
   // rehashing
@@ -1273,7 +1356,7 @@ bool Tester::testRehashDeletionFactor(int filesysSize, int numdataPoints,
 
   // Count the number of live data points in the current table
   int liveDataCurrent =
-      countLiveData(newSys.m_currentTable, newSys.m_currentCap);
+      countLiveData(newSys.m_currCtrl, newSys.m_currentCap);
   int actualDataPoints = numdataPoints - numRemovals;
 
   // Compare the actual number of live data points to the expected number after
@@ -1465,111 +1548,2517 @@ bool Tester::testmidRehashDeletion(int filesysSize, int numdataPoints,
                 // rehashing has not occurred)
 }
 
-int main() {
-  Tester aTester;
+// Name: verifyControlBytes
+// Desc: Checks the control bytes of a table against its slots. Every live slot
+// must carry the tag of its file and the bytes past the end of the table must
+// mirror the first GROUPWIDTH bytes.
+// Parameters:
+//    - ctrl: the control bytes of the hash table.
+//    - table: a pointer to the hash table (array of slots).
+//    - cap: the capacity of the hash table.
+//    - hash: the hash function used by the FileSys object.
+// Preconditions:
+//    - The table and its control bytes are allocated with cap slots.
+// Postconditions:
+//    - Returns true if every control byte is consistent, false otherwise.
+bool Tester::verifyControlBytes(const unsigned char *ctrl, Slot *table, int cap,
+                                hash_fn hash) {
+  for (int i = 0; i < cap; i++) {
+    // a live slot must be tagged with the top 7 bits of its mixed hash
+    if ((ctrl[i] & 0x80) == 0) {
+      unsigned int mixed =
+          FileSys::mixHash(hash(table[i].getName()), table[i].getDiskBlock());
+      if (ctrl[i] != (mixed >> 25)) {
+        return false;
+      }
+      // the cached hash must be the hash of the name in the slot
+      if (table[i].getHash() != hash(table[i].getName())) {
+        return false;
+      }
+    } else if (ctrl[i] != CTRL_EMPTY && ctrl[i] != CTRL_DELETED) {
+      return false; // a control byte with the high bit set must be a marker
+    }
+  }
 
-  cout << "Testing for Normal Non Collision Handling" << endl;
+  // the mirrored group lets a group load start at any slot
+  for (int i = 0; i < GROUPWIDTH; i++) {
+    if (ctrl[cap + i] != ctrl[i]) {
+      return false;
+    }
+  }
+  return true;
+}
 
-  if (aTester.testforNormalNonCollide(70, 25, hashCode, QUADRATIC,
-                                      NON_COLLIDE)) {
-    cout << "Testing test for Non Collision case passed!" << endl;
+// Name: testSwissControlBytes
+// Desc: Tests the SWISS policy with many files sharing a name. It inserts the
+// files, removes some of them and checks that every lookup still finds the
+// right files and that the control bytes stay consistent with the slots.
+// Parameters:
+//    - filesysSize: the size of the FileSys object to be created.
+//    - numdataPoints: the number of data points (files) to be inserted.
+//    - hash: the hash function to be used by the FileSys object.
+//    - dataSetType: the type of dataset to be generated and inserted.
+//    - removals: the number of files to remove.
+// Preconditions:
+//    - removals must not be larger than numdataPoints.
+// Postconditions:
+//    - Returns true if the table holds exactly the remaining files and its
+//    control bytes are valid, false otherwise.
+bool Tester::testSwissControlBytes(int filesysSize, int numdataPoints,
+                                   hash_fn hash, DataSetType dataSetType,
+                                   int removals) {
+  FileSys newSys =
+      generateDataSet(filesysSize, numdataPoints, hash, SWISS, dataSetType);
 
-  } else {
-    cout << "Testing for Non Collision Handling case failed!" << endl;
+  // Every inserted file must be found through the control byte groups
+  for (vector<File>::const_iterator it = m_dataList.begin();
+       it != m_dataList.end(); ++it) {
+    if (!(newSys.getFile(it->getName(), it->getDiskBlock()) == *it)) {
+      return false;
+    }
   }
-  aTester.clearData();
-  cout << "Testing an Error case for getFile method Handling" << endl;
 
-  if (aTester.testFindError(200, 50, hashCode, DOUBLEHASH, NAMES_DB)) {
-    cout << "Testing an Error case for getFile method Handling passed !"
-         << endl;
-  } else {
-    cout << "Testing an Error case for getFile method case failed!" << endl;
+  // Remove the first files of the list
+  for (int i = 0; i < removals; i++) {
+    File file = m_dataList[0];
+    if (!newSys.remove(file)) {
+      return false;
+    }
+    m_dataList.erase(m_dataList.begin());
+    m_dataRemoved.push_back(file);
   }
-  aTester.clearData();
-  cout << "Testing a Normal case for getFile method Handling (Non-Collide)"
-       << endl;
-  if (aTester.testFindNonCollide(200, 50, hashCode, LINEAR, NON_COLLIDE)) {
-    cout << "Testing a Normal case for getFile method Handling passed !"
-         << endl;
-  } else {
-    cout << "Testing a Normal case for getFile method case failed!" << endl;
+
+  if (!verifyData(newSys)) {
+    return false;
   }
-  aTester.clearData();
-  cout << "Testing a Normal case for getFile method Handling (Collide)" << endl;
 
-  if (aTester.testFindColllide(101, 20, hashCode, QUADRATIC, COLLIDE)) {
-    cout << "Testing a Normal case for getFile method Handling passed !"
-         << endl;
-  } else {
-    cout << "Testing a Normal case for getFile method case failed!" << endl;
+  // A lookup for a block that was never used must miss
+  if (newSys.getFile(m_dataList[0].getName(), DISKMIN - 1).getUsed()) {
+    return false;
   }
 
-  aTester.clearData();
-  cout << "Testing a Normal case for remove method Handling (Non-colliding)"
-       << endl;
+  if (!verifyControlBytes(newSys.m_currCtrl, newSys.m_currentTable,
+                          newSys.m_currentCap, hash)) {
+    return false;
+  }
+  if (newSys.m_oldTable != nullptr &&
+      !verifyControlBytes(newSys.m_oldCtrl, newSys.m_oldTable, newSys.m_oldCap,
+                          hash)) {
+    return false;
+  }
 
-  if (aTester.testRemoveWithNonCollide(101, 30, hashCode, DOUBLEHASH,
-                                       NON_COLLIDE, 10)) {
-    cout << "Testing a Normal case for remove method Handling passed !" << endl;
-  } else {
-    cout << "Testing a Normal case for remove method Handling failed!" << endl;
+  // Every remaining file is live in one of the two tables
+  int liveData = countLiveData(newSys.m_currCtrl, newSys.m_currentCap);
+  if (newSys.m_oldTable != nullptr) {
+    liveData += countLiveData(newSys.m_oldCtrl, newSys.m_oldCap);
   }
-  aTester.clearData();
-  cout << "Testing error case for remove method " << endl;
+  return liveData == numdataPoints - removals;
+}
 
-  if (aTester.testRemoveWithNonCollide(400, 100, hashCode, LINEAR, NAMES_DB,
-                                       10)) {
-    cout << "Testing error case passed !" << endl;
-  } else {
-    cout << "Testing error case failed!" << endl;
+// Name: testHashOncePerInsert
+// Desc: Tests that the name of a file is hashed exactly once when it is
+// inserted. The files are inserted until several rehash operations happened,
+// the migration must place the files by their cached hash values.
+// Parameters:
+//    - numdataPoints: the number of data points (files) to be inserted.
+//    - probing: the probing technique to be used by the FileSys object.
+// Preconditions:
+//    - numdataPoints must be large enough to trigger a rehash.
+// Postconditions:
+//    - Returns true if the hash function ran once per insert, false otherwise.
+bool Tester::testHashOncePerInsert(int numdataPoints, prob_t probing) {
+  FileSys newSys(MINPRIME, countingHash, probing);
+  hashCalls = 0;
+
+  for (int i = 0; i < numdataPoints; i++) {
+    newSys.insert(File("file" + to_string(i) + ".txt", DISKMIN + i, true));
   }
-  aTester.clearData();
-  cout << "Testing Normal case for remove method (Collide)" << endl;
 
-  if (aTester.testRemoveWithCollideNoRehash(400, 100, hashCode, LINEAR, COLLIDE,
-                                            10)) {
-    cout << "Testing Normal case for remove passed !" << endl;
-  } else {
-    cout << "Testing Normal case for remove failed!" << endl;
+  // the table must have grown, otherwise no migration was tested
+  if (newSys.m_currentCap <= MINPRIME) {
+    return false;
   }
+  return hashCalls == numdataPoints;
+}
 
-  aTester.clearData();
-  cout << "Testing Normal case of triggering rehash method  " << endl;
+// Name: testUpdateDiskBlock
+// Desc: Tests updateDiskBlock by moving every file to a new block. A file must
+// be found under its new block and not under its old one afterwards.
+// Parameters:
+//    - filesysSize: the size of the FileSys object to be created.
+//    - numdataPoints: the number of data points (files) to be inserted.
+//    - hash: the hash function to be used by the FileSys object.
+//    - probing: the probing technique to be used by the FileSys object.
+//    - dataSetType: the type of dataset to be generated and inserted.
+// Preconditions:
+//    - The random blocks of the data set are larger than DISKMIN +
+//    numdataPoints, which holds for the fixed seed of Random.
+// Postconditions:
+//    - Returns true if every update is visible through getFile.
+bool Tester::testUpdateDiskBlock(int filesysSize, int numdataPoints,
+                                 hash_fn hash, prob_t probing,
+                                 DataSetType dataSetType) {
+  FileSys newSys =
+      generateDataSet(filesysSize, numdataPoints, hash, probing, dataSetType);
 
-  if (aTester.testmidRehash(101, 49, hashCode, QUADRATIC, NAMES_DB)) {
-    cout << "Testing Normal case of  triggering rehash method passed !" << endl;
-  } else {
-    cout << "Testing Normal case of triggering rehash method failed!" << endl;
+  for (int i = 0; i < (int)m_dataList.size(); i++) {
+    File oldFile = m_dataList[i];
+    if (!newSys.updateDiskBlock(oldFile, DISKMIN + i)) {
+      return false;
+    }
+    m_dataList[i].setDiskBlock(DISKMIN + i);
+    m_dataRemoved.push_back(oldFile);
   }
-  aTester.clearData();
-  cout << "Testing Normal case for rehash method with Completion" << endl;
 
-  if (aTester.testRehash(101, 55, hashCode, QUADRATIC, NAMES_DB)) {
-    cout << "Testing Normal case for rehash method passed !" << endl;
-  } else {
-    cout << "Testing Normal case for rehash method failed!" << endl;
+  // An update to a block outside of the disk must be rejected
+  if (newSys.updateDiskBlock(m_dataList[0], DISKMAX + 1)) {
+    return false;
   }
 
-  aTester.clearData();
-  cout << "Testing Normal case of triggering rehash method with Deletion "
-          "factor > 0.8 "
-       << endl;
-  if (aTester.testmidRehashDeletion(101, 48, hashCode, LINEAR, COLLIDE, 35)) {
-    cout << "Testing Normal case for rehash method passed !" << endl;
-  } else {
-    cout << "Testing Normal case for rehash method failed!" << endl;
+  // verifyData checks that the old blocks are gone
+  if (!verifyData(newSys)) {
+    return false;
   }
-  aTester.clearData();
+  for (vector<File>::const_iterator it = m_dataList.begin();
+       it != m_dataList.end(); ++it) {
+    if (!(newSys.getFile(it->getName(), it->getDiskBlock()) == *it)) {
+      return false;
+    }
+  }
+  return true;
+}
 
-  cout << "Testing Normal case of rehash method with Deletion factor > 0.8 "
-          "with Completion "
-       << endl;
-  if (aTester.testRehashDeletionFactor(101, 47, hashCode, QUADRATIC, NAMES_DB,
-                                       39)) {
-    cout << "Testing Normal case for rehash method passed !" << endl;
-  } else {
-    cout << "Testing Normal case for rehash method failed!" << endl;
+// Name: testRobinHoodRemoval
+// Desc: Tests the backward shift deletion of the ROBINHOOD policy. Files are
+// removed and inserted again for several rounds, the current table must never
+// hold a tombstone and the probe distances must stay in Robin Hood order.
+// Parameters:
+//    - filesysSize: the size of the FileSys object to be created.
+//    - numdataPoints: the number of data points (files) to be inserted.
+//    - hash: the hash function to be used by the FileSys object.
+//    - dataSetType: the type of dataset to be generated and inserted.
+//    - rounds: the number of remove and insert rounds.
+// Preconditions:
+//    - numdataPoints stays below the load factor limit of filesysSize.
+// Postconditions:
+//    - Returns true if no tombstone and no rehash happened, false otherwise.
+bool Tester::testRobinHoodRemoval(int filesysSize, int numdataPoints,
+                                  hash_fn hash, DataSetType dataSetType,
+                                  int rounds) {
+  FileSys newSys =
+      generateDataSet(filesysSize, numdataPoints, hash, ROBINHOOD, dataSetType);
+  if (newSys.m_oldTable != nullptr) {
+    return false;
+  }
+
+  for (int round = 0; round < rounds; round++) {
+    for (int i = 0; i < (int)m_dataList.size(); i++) {
+      if (!newSys.remove(m_dataList[i])) {
+        return false;
+      }
+      // without tombstones the deleted ratio can never trigger a rehash
+      if (newSys.m_currNumDeleted != 0 || newSys.m_oldTable != nullptr) {
+        return false;
+      }
+      if (newSys.getFile(m_dataList[i].getName(), m_dataList[i].getDiskBlock())
+              .getUsed()) {
+        return false;
+      }
+      if (!newSys.insert(m_dataList[i])) {
+        return false;
+      }
+    }
+  }
+
+  // a file is never closer to its home bucket than its left neighbor allows
+  for (size_t i = 0; i < newSys.m_currentCap; i++) {
+    if (newSys.m_currCtrl[i] == CTRL_DELETED) {
+      return false;
+    }
+    size_t next = (i + 1) % newSys.m_currentCap;
+    if ((newSys.m_currCtrl[next] & 0x80) == 0 &&
+        newSys.probeDistance(next, 1) > 0) {
+      if ((newSys.m_currCtrl[i] & 0x80) != 0 ||
+          newSys.probeDistance(next, 1) > newSys.probeDistance(i, 1) + 1) {
+        return false;
+      }
+    }
+  }
+
+  if (newSys.m_currentSize != (size_t)numdataPoints) {
+    return false;
+  }
+  return verifyData(newSys);
+}
+
+// Name: verifyCuckooPlacement
+// Desc: Checks that every live file of a CUCKOO table is in one of its two
+// buckets or in the stash. Parameters:
+//    - table: a pointer to the hash table (array of slots).
+//    - ctrl: the control bytes of the hash table.
+//    - cap: the capacity of the hash table.
+// Postconditions:
+//    - Returns true if every file can be reached by a lookup.
+bool Tester::verifyCuckooPlacement(Slot *table, const unsigned char *ctrl,
+                                   size_t cap) {
+  for (size_t i = 0; i < cap; i++) {
+    if (ctrl[i] & 0x80) {
+      continue;
+    }
+    size_t first, second;
+    FileSys::cuckooBuckets(table[i].m_hash, table[i].m_diskBlock, cap, first,
+                           second);
+    size_t bucket = i / CUCKOOWAYS;
+    if (bucket != first && bucket != second && i < cap - CUCKOOSTASH) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Name: testCuckooPlacement
+// Desc: Tests the CUCKOO policy. Every file must stay in one of its two
+// buckets or the stash through inserts, rehashes and removals, and a removal
+// must empty the bucket instead of leaving a deleted one behind.
+// Parameters:
+//    - filesysSize: the size of the FileSys object to be created.
+//    - numdataPoints: the number of data points (files) to be inserted.
+//    - hash: the hash function to be used by the FileSys object.
+//    - dataSetType: the type of dataset to be generated and inserted.
+//    - removals: the number of data points (files) to be removed.
+// Postconditions:
+//    - Returns true if all files are placed and found correctly.
+bool Tester::testCuckooPlacement(int filesysSize, int numdataPoints,
+                                 hash_fn hash, DataSetType dataSetType,
+                                 int removals) {
+  FileSys newSys =
+      generateDataSet(filesysSize, numdataPoints, hash, CUCKOO, dataSetType);
+
+  for (int i = 0; i < removals; i++) {
+    File file = m_dataList[0];
+    if (!newSys.remove(file)) {
+      return false;
+    }
+    m_dataList.erase(m_dataList.begin());
+    m_dataRemoved.push_back(file);
+  }
+
+  if (!verifyCuckooPlacement(newSys.m_currentTable, newSys.m_currCtrl,
+                             newSys.m_currentCap)) {
+    return false;
+  }
+  if (newSys.m_oldTable != nullptr &&
+      !verifyCuckooPlacement(newSys.m_oldTable, newSys.m_oldCtrl,
+                             newSys.m_oldCap)) {
+    return false;
+  }
+  if (newSys.m_currNumDeleted != 0) {
+    return false;
+  }
+  for (size_t i = 0; i < newSys.m_currentCap; i++) {
+    if (newSys.m_currCtrl[i] == CTRL_DELETED) {
+      return false;
+    }
+  }
+  return verifyData(newSys);
+}
+
+// Name: testCuckooCycle
+// Desc: Tests the fallback of the CUCKOO policy. The files share their hash
+// and block, so they all have the same two buckets. Once the buckets and the
+// stash are full the next insert must start a rehash instead of failing, and
+// a file the new table has no room for must stay in the old table until a
+// removal makes room.
+// Parameters: None
+// Postconditions:
+//    - Returns true if no file is lost, false otherwise.
+bool Tester::testCuckooCycle() {
+  FileSys newSys(MINPRIME, sameHash, CUCKOO);
+  int full = 2 * CUCKOOWAYS + CUCKOOSTASH;
+
+  for (int i = 0; i < full; i++) {
+    m_dataList.push_back(File("file" + to_string(i), DISKMIN, true));
+    if (!newSys.insert(m_dataList.back())) {
+      return false;
+    }
+  }
+  // the load factor is low, only the cycle can start a rehash
+  if (newSys.m_oldTable != nullptr) {
+    return false;
+  }
+  for (size_t i = newSys.m_currentCap - CUCKOOSTASH; i < newSys.m_currentCap;
+       i++) {
+    if (newSys.m_currCtrl[i] & 0x80) {
+      return false; // the stash must be in use
+    }
+  }
+
+  m_dataList.push_back(File("file" + to_string(full), DISKMIN, true));
+  if (!newSys.insert(m_dataList.back()) || newSys.m_oldTable == nullptr) {
+    return false;
+  }
+  if (!verifyData(newSys)) {
+    return false;
+  }
+
+  // the removals make room, the file that was left behind moves over and the
+  // old table is released
+  for (int i = 0; i < 4; i++) {
+    File file = m_dataList[0];
+    if (!newSys.remove(file)) {
+      return false;
+    }
+    m_dataList.erase(m_dataList.begin());
+    m_dataRemoved.push_back(file);
+  }
+  if (newSys.m_oldTable != nullptr) {
+    return false;
+  }
+  return verifyData(newSys);
+}
+
+// Name: testEqualHash
+// Desc: Tests the limit on files that share their buckets, or their
+// neighborhood in HOPSCOTCH. With sameHash at one block every file has the
+// same home, no capacity separates them, and a table holds only ceiling of
+// them; the others must be refused, not lost. A GROUPSTORE slot is keyed by
+// its name alone, so there the files get distinct blocks and hit the same
+// limit.
+// A QUADRATIC table stores them all. Parameters:
+//    - probing: CUCKOO or HOPSCOTCH.
+//    - storeMode: FILESTORE or GROUPSTORE.
+//    - ceiling: the files of one home the current table can hold.
+// Postconditions:
+//    - Returns true if the current table holds at most ceiling files, the
+//    stored files are found, and a retry stores nothing new.
+bool Tester::testEqualHash(prob_t probing, store_t storeMode, int ceiling) {
+  FileSys newSys(MINPRIME, sameHash, probing, PRIMECAP, storeMode);
+  FileSys probed(MINPRIME, sameHash, QUADRATIC, PRIMECAP, storeMode);
+  vector<File> files;
+  for (int i = 0; i < 64; i++) {
+    int block = (storeMode == GROUPSTORE) ? DISKMIN + i : DISKMIN;
+    files.push_back(File("file" + to_string(i), block, true));
+  }
+  int stored = 0;
+  for (const File &file : files) {
+    if (newSys.insert(file)) {
+      m_dataList.push_back(file);
+      stored++;
+    }
+    if (!probed.insert(file)) {
+      return false;
+    }
+  }
+  for (const File &file : files) {
+    if (newSys.insert(file)) {
+      return false;
+    }
+  }
+  return stored >= ceiling && stored < 64 &&
+         newSys.m_currentSize == (size_t)ceiling && verifyData(newSys);
+}
+
+// Name: verifyHopBitmaps
+// Desc: Checks the neighborhood bitmaps of a HOPSCOTCH current table. Every
+// live file must be within HOPRANGE slots of its home bucket and have its bit
+// set there, and every set bit must point at a live file of that bucket.
+// Parameters:
+//    - filesys: the FileSys object, its current table uses HOPSCOTCH.
+// Postconditions:
+//    - Returns true if the bitmaps match the slots.
+bool Tester::verifyHopBitmaps(const FileSys &filesys) {
+  int cap = filesys.m_currentCap;
+  int bits = 0;
+  for (int bucket = 0; bucket < cap; bucket++) {
+    for (int dist = 0; dist < HOPRANGE; dist++) {
+      if (!(filesys.m_currHop[bucket] & (1u << dist))) {
+        continue;
+      }
+      int index = (bucket + dist) % cap;
+      const Slot &slot = filesys.m_currentTable[index];
+      if ((filesys.m_currCtrl[index] & 0x80) ||
+          (int)(FileSys::mixHash(slot.m_hash, slot.m_diskBlock) % cap) !=
+              bucket) {
+        return false;
+      }
+      bits++;
+    }
+  }
+  // a bit for every live file, so no file is out of its neighborhood
+  return bits == countLiveData(filesys.m_currCtrl, cap);
+}
+
+// Name: testHopscotch
+// Desc: Tests the HOPSCOTCH policy. The table must accept files up to its
+// higher load factor limit without a rehash, keep the neighborhood bitmaps in
+// sync through inserts and removals, and never hold a deleted bucket.
+// Parameters:
+//    - filesysSize: the size of the FileSys object to be created.
+//    - numdataPoints: the number of data points (files) to be inserted.
+//    - hash: the hash function to be used by the FileSys object.
+//    - dataSetType: the type of dataset to be generated and inserted.
+//    - removals: the number of data points (files) to be removed.
+// Postconditions:
+//    - Returns true if all files are placed and found correctly.
+bool Tester::testHopscotch(int filesysSize, int numdataPoints, hash_fn hash,
+                           DataSetType dataSetType, int removals) {
+  FileSys newSys =
+      generateDataSet(filesysSize, numdataPoints, hash, HOPSCOTCH, dataSetType);
+
+  // below HOPMAXLOAD the first table keeps all files
+  if (numdataPoints <= HOPMAXLOAD * filesysSize &&
+      (newSys.m_oldTable != nullptr || newSys.m_currentCap != (size_t)filesysSize)) {
+    return false;
+  }
+  if (newSys.m_oldTable == nullptr && !verifyHopBitmaps(newSys)) {
+    return false;
+  }
+
+  for (int i = 0; i < removals; i++) {
+    File file = m_dataList[0];
+    if (!newSys.remove(file)) {
+      return false;
+    }
+    m_dataList.erase(m_dataList.begin());
+    m_dataRemoved.push_back(file);
+  }
+
+  if (!verifyHopBitmaps(newSys) || newSys.m_currNumDeleted != 0) {
+    return false;
+  }
+  return verifyData(newSys);
+}
+
+// Name: testLargeCapacity
+// Desc: Tests that a table is no longer limited to 99991 slots. A size above
+// that value is rounded up to a prime capacity by the constructor, and a table
+// that starts small keeps growing while more files than the old limit allowed
+// are inserted.
+// Parameters:
+//    - numdataPoints: the number of data points (files) to be inserted.
+//    - probing: the probing technique to be used by the FileSys object.
+// Postconditions:
+//    - Returns true if the table grew past the old limit and every file is
+//    found.
+bool Tester::testLargeCapacity(int numdataPoints, prob_t probing) {
+  FileSys bigSys(200003, hashCode, probing);
+  if (bigSys.m_currentCap < 200003 || !bigSys.isPrime(bigSys.m_currentCap)) {
+    return false;
+  }
+
+  FileSys newSys(MINPRIME, hashCode, probing);
+  for (int i = 0; i < numdataPoints; i++) {
+    if (!newSys.insert(File("file" + to_string(i) + ".txt",
+                            DISKMIN + i % (DISKMAX - DISKMIN), true))) {
+      return false;
+    }
+  }
+  if (newSys.m_currentCap <= 99991 ||
+      newSys.getNumData() + newSys.m_oldSize != (size_t)numdataPoints) {
+    return false;
+  }
+  for (int i = 0; i < numdataPoints; i++) {
+    if (!newSys.getFile("file" + to_string(i) + ".txt",
+                        DISKMIN + i % (DISKMAX - DISKMIN))
+             .getUsed()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Name: testPowerOfTwoCapacity
+// Desc: Tests a POW2CAP table. The capacity is a power of two after the
+// constructor and after every rehash, the probe sequence of the policy reaches
+// every slot of the table, and every file is found after growth and removals.
+// Parameters:
+//    - numdataPoints: the number of data points (files) to be inserted.
+//    - probing: the probing technique to be used by the FileSys object.
+// Postconditions:
+//    - Returns true if all the checks pass.
+bool Tester::testPowerOfTwoCapacity(int numdataPoints, prob_t probing) {
+  FileSys newSys(MINPRIME, hashCode, probing, POW2CAP);
+  if (newSys.m_currentCap != 128) {
+    return false;
+  }
+
+  // a probe sequence must not cycle through only part of the table
+  if (probing == QUADRATIC || probing == DOUBLEHASH || probing == LINEAR) {
+    vector<bool> seen(newSys.m_currentCap, false);
+    size_t index = 37;
+    size_t step = 0;
+    for (size_t i = 0; i < newSys.m_currentCap; i++) {
+      seen[index] = true;
+      step++;
+      index = newSys.getNextIndex(index, step, newSys.m_currentCap, 37, 1);
+    }
+    for (size_t i = 0; i < seen.size(); i++) {
+      if (!seen[i]) {
+        return false;
+      }
+    }
+  }
+
+  for (int i = 0; i < numdataPoints; i++) {
+    if (!newSys.insert(File("file" + to_string(i) + ".txt",
+                            DISKMIN + i % (DISKMAX - DISKMIN), true))) {
+      return false;
+    }
+    size_t cap = newSys.m_currentCap;
+    if ((cap & (cap - 1)) != 0) {
+      return false;
+    }
+  }
+  if (newSys.m_currentCap <= 128) {
+    return false;
+  }
+  for (int i = 0; i < numdataPoints; i += 2) {
+    if (!newSys.remove(File("file" + to_string(i) + ".txt",
+                            DISKMIN + i % (DISKMAX - DISKMIN), true))) {
+      return false;
+    }
+  }
+  for (int i = 0; i < numdataPoints; i++) {
+    bool found = newSys.getFile("file" + to_string(i) + ".txt",
+                                DISKMIN + i % (DISKMAX - DISKMIN))
+                     .getUsed();
+    if (found != (i % 2 == 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Name: testFastModulus
+// Desc: Tests that the home bucket of a prime table, computed from the fast
+// modulus constant, is the remainder of the hash value for several prime
+// capacities, including ones close to the 32 bit limit. Parameters: None
+// Postconditions:
+//    - Returns true if fastMod and homeIndex match the % operator on every
+//    value.
+bool Tester::testFastModulus() {
+  size_t caps[] = {101, 409, 99991, 1000003, 2147483647, 4294967291u};
+  unsigned int values[] = {0, 1, 100, 101, 12345, 2147483647u, 2147483648u,
+                           4294967291u, 4294967295u};
+  mt19937 gen(10);
+  for (size_t cap : caps) {
+    uint64_t magic = modMagic(cap);
+    for (unsigned int value : values) {
+      if (FileSys::fastMod(value, magic, cap) != value % cap) {
+        return false;
+      }
+    }
+    for (int i = 0; i < 100000; i++) {
+      unsigned int value = gen();
+      if (FileSys::fastMod(value, magic, cap) != value % cap) {
+        return false;
+      }
+    }
+  }
+
+  // a real table reduces its hash values the same way
+  FileSys newSys(99991, hashCode, QUADRATIC);
+  for (int i = 0; i < 1000; i++) {
+    unsigned int value = gen();
+    if (newSys.homeIndex(value, 1) != value % newSys.m_currentCap) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Name: testPrimeCapacities
+// Desc: Tests the compile time table of prime capacities. Walking the table
+// with findNextPrime must give primes (checked by trial division) that grow by
+// at most about 1/PRIMEGROWTH, each with the right fast modulus constant, and
+// the constructor and isPrime must agree with it. Parameters: None
+// Postconditions:
+//    - Returns true if all the checks pass.
+bool Tester::testPrimeCapacities() {
+  FileSys newSys(MINPRIME, hashCode, QUADRATIC);
+  if (newSys.m_currentCap != MINPRIME || newSys.findNextPrime(0) != MINPRIME) {
+    return false;
+  }
+
+  // every number below 100000 is checked against trial division
+  for (size_t number = 0; number < 100000; number++) {
+    bool prime = number >= 2;
+    for (size_t i = 2; i * i <= number && prime; i++) {
+      prime = (number % i != 0);
+    }
+    if (newSys.isPrime(number) != prime) {
+      return false;
+    }
+  }
+
+  size_t cap = MINPRIME;
+  int count = 1;
+  while (cap < ((size_t)1 << 40)) {
+    size_t next = newSys.findNextPrime(cap);
+    if (next <= cap || next > cap + cap / PRIMEGROWTH + cap / 64 + 16 ||
+        !newSys.isPrime(next) || newSys.findNextPrime(next - 1) != next ||
+        newSys.findNextPrime((cap + next) / 2) != next) {
+      return false;
+    }
+    TableCap entry = FileSys::primeCapAtLeast(next);
+    if (entry.m_cap != next || entry.m_magic != modMagic(next)) {
+      return false;
+    }
+    cap = next;
+    count++;
+  }
+  // a prime below 2^20 is checked by trial division too
+  for (size_t prime = MINPRIME; prime < (1 << 20);
+       prime = newSys.findNextPrime(prime)) {
+    for (size_t i = 2; i * i <= prime; i++) {
+      if (prime % i == 0) {
+        return false;
+      }
+    }
+  }
+
+  // a size of the constructor is rounded up to the table
+  FileSys sizedSys(1000, hashCode, SWISS);
+  return count < NUMPRIMECAPS &&
+         sizedSys.m_currentCap == newSys.findNextPrime(999) &&
+         sizedSys.m_currMagic == modMagic(sizedSys.m_currentCap);
+}
+
+// Name: testHasherFunctor
+// Desc: Tests the string_view hashers. A table built with the TextbookHash
+// functor and one built with a view_hash_fn must place every file in the same
+// slot as a table built with the equivalent hash_fn, through all rehashes and
+// removals, and the view_hash_fn must run once per operation.
+// Parameters:
+//    - numdataPoints: the number of data points (files) to be inserted.
+//    - probing: the probing technique to be used by the FileSys object.
+// Postconditions:
+//    - Returns true if the three tables stay identical.
+bool Tester::testHasherFunctor(int numdataPoints, prob_t probing) {
+  FileSys fnSys(MINPRIME, hashCode, probing);
+  FileSys functorSys(MINPRIME, TextbookHash(), probing);
+  FileSys viewSys(MINPRIME, viewHash, probing);
+  if (functorSys.m_hash != nullptr || viewSys.m_viewHash != viewHash) {
+    return false;
+  }
+
+  hashCalls = 0;
+  for (int i = 0; i < numdataPoints; i++) {
+    File file("logs/worker-" + to_string(i) + ".log", DISKMIN + i, true);
+    if (!fnSys.insert(file) || !functorSys.insert(file) ||
+        !viewSys.insert(file)) {
+      return false;
+    }
+  }
+  for (int i = 0; i < numdataPoints; i += 3) {
+    File file("logs/worker-" + to_string(i) + ".log", DISKMIN + i, true);
+    if (!fnSys.remove(file) || !functorSys.remove(file) ||
+        !viewSys.remove(file)) {
+      return false;
+    }
+  }
+  if (hashCalls != numdataPoints + (numdataPoints + 2) / 3) {
+    return false;
+  }
+
+  const FileSys *systems[] = {&functorSys, &viewSys};
+  for (const FileSys *other : systems) {
+    if (other->m_currentCap != fnSys.m_currentCap) {
+      return false;
+    }
+    for (size_t i = 0; i < fnSys.m_currentCap; i++) {
+      if (other->m_currCtrl[i] != fnSys.m_currCtrl[i] ||
+          other->m_currentTable[i].m_name != fnSys.m_currentTable[i].m_name) {
+        return false;
+      }
+    }
+  }
+  for (int i = 0; i < numdataPoints; i++) {
+    string name = "logs/worker-" + to_string(i) + ".log";
+    if (functorSys.getFile(name, DISKMIN + i).getUsed() != (i % 3 != 0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Name: testZeroCopyLookup
+// Desc: Tests that findFile does not allocate. Files with names too long for
+// the small string buffer are inserted until the table rehashed, then every
+// file is looked up by std::string, by C string and by string_view, and
+// missing files are looked up too, while the heap allocations are counted.
+// Parameters:
+//    - numdataPoints: the number of data points (files) to be inserted.
+//    - probing: the probing technique to be used by the FileSys object.
+// Postconditions:
+//    - Returns true if the lookups find the right files without a single
+//    allocation, and getFile (which returns a copy) does allocate.
+bool Tester::testZeroCopyLookup(int numdataPoints, prob_t probing) {
+  FileSys newSys(MINPRIME, TextbookHash(), probing);
+  vector<string> names;
+  for (int i = 0; i < numdataPoints; i++) {
+    names.push_back("logs/2026-10/service/worker-" + to_string(i) + ".log");
+    newSys.insert(File(names[i], DISKMIN + i, true));
+  }
+  if (newSys.m_currentCap <= MINPRIME) {
+    return false;
+  }
+
+  allocCalls = 0;
+  bool correct = true;
+  for (int i = 0; i < numdataPoints; i++) {
+    const Slot *byString = newSys.findFile(names[i], DISKMIN + i);
+    const Slot *byChars = newSys.findFile(names[i].c_str(), DISKMIN + i);
+    const Slot *byView =
+        newSys.findFile(string_view(names[i]).substr(0), DISKMIN + i);
+    correct = correct && byString != nullptr && byString == byChars &&
+              byString == byView && byString->getName() == names[i] &&
+              byString->getDiskBlock() == DISKMIN + i;
+    correct = correct && newSys.findFile(names[i], DISKMAX) == nullptr &&
+              newSys.findFile("no such file", DISKMIN + i) == nullptr;
+  }
+  int lookupAllocs = allocCalls;
+
+  // the counter must see the copy that getFile makes
+  allocCalls = 0;
+  newSys.getFile(names[0], DISKMIN);
+  return correct && lookupAllocs == 0 && allocCalls > 0;
+}
+
+// Name: testMoveInsert
+// Desc: Tests the heap allocations of the three ways to insert. The table is
+// large enough that no rehash happens, a moved File must cost no allocation,
+// emplace and a copied File one allocation per name, and a rejected emplace
+// none. Every file must be found afterwards. Parameters:
+//    - numdataPoints: the number of data points (files) to be inserted.
+//    - probing: the probing technique to be used by the FileSys object.
+// Postconditions:
+//    - Returns true if all the checks pass.
+bool Tester::testMoveInsert(int numdataPoints, prob_t probing) {
+  FileSys newSys(8 * numdataPoints, TextbookHash(), probing);
+  vector<File> files;
+  vector<string> names;
+  for (int i = 0; i < 3 * numdataPoints; i++) {
+    names.push_back("logs/2026-10/service/worker-" + to_string(i) + ".log");
+    files.push_back(File(names[i], DISKMIN + i, true));
+  }
+
+  allocCalls = 0;
+  for (int i = 0; i < numdataPoints; i++) {
+    if (!newSys.insert(std::move(files[i]))) {
+      return false;
+    }
+  }
+  int moveAllocs = allocCalls;
+
+  allocCalls = 0;
+  for (int i = numdataPoints; i < 2 * numdataPoints; i++) {
+    if (!newSys.emplace(names[i], DISKMIN + i)) {
+      return false;
+    }
+  }
+  int emplaceAllocs = allocCalls;
+
+  allocCalls = 0;
+  for (int i = 2 * numdataPoints; i < 3 * numdataPoints; i++) {
+    if (!newSys.insert(files[i])) {
+      return false;
+    }
+  }
+  int copyAllocs = allocCalls;
+
+  // a duplicate and an invalid block are rejected before the name is copied
+  allocCalls = 0;
+  if (newSys.emplace(names[0], DISKMIN) || newSys.emplace(names[0], 0) ||
+      newSys.insert(std::move(files[2 * numdataPoints])) ||
+      files[2 * numdataPoints].m_name != names[2 * numdataPoints]) {
+    return false;
+  }
+  int rejectAllocs = allocCalls;
+
+  if (moveAllocs != 0 || emplaceAllocs != numdataPoints ||
+      copyAllocs != numdataPoints || rejectAllocs != 0 ||
+      newSys.m_oldTable != nullptr) {
+    return false;
+  }
+  for (int i = 0; i < 3 * numdataPoints; i++) {
+    if (newSys.findFile(names[i], DISKMIN + i) == nullptr) {
+      return false;
+    }
+  }
+  return newSys.getNumData() == (size_t)(3 * numdataPoints);
+}
+
+// Name: testFindAll
+// Desc: Tests findAll with the names of NAMES_DB, where every name is stored
+// under many blocks. Files are removed and moved to new blocks, and for every
+// name findAll must return exactly the blocks of the remaining files. In a
+// table that places files by name alone the name index must point at them.
+// Parameters:
+//    - filesysSize: the size of the FileSys object to be created.
+//    - numdataPoints: the number of data points (files) to be inserted.
+//    - hash: the hash function to be used by the FileSys object.
+//    - probing: the probing technique to be used by the FileSys object.
+//    - removals: the number of data points (files) to be removed.
+// Postconditions:
+//    - Returns true if findAll matches the data list for every name.
+bool Tester::testFindAll(int filesysSize, int numdataPoints, hash_fn hash,
+                         prob_t probing, int removals) {
+  FileSys newSys =
+      generateDataSet(filesysSize, numdataPoints, hash, probing, NAMES_DB);
+  for (int i = 0; i < removals; i++) {
+    if (!newSys.remove(m_dataList[0])) {
+      return false;
+    }
+    m_dataList.erase(m_dataList.begin());
+  }
+  // a few files move to blocks no other file uses
+  for (int i = 0; i < 10; i++) {
+    if (!newSys.updateDiskBlock(m_dataList[i], DISKMAX - i)) {
+      return false;
+    }
+    m_dataList[i].setDiskBlock(DISKMAX - i);
+  }
+
+  vector<string> names = {"driver.cpp",  "test.cpp",          "test.h",
+                          "info.txt",    "mydocument.docx",   "tempsheet.xlsx",
+                          "report.pdf",  "presentation.pptx", "data.csv",
+                          "image.png",   "notes.txt",         "summary.doc",
+                          "archive.zip", "script.js",         "stylesheet.css",
+                          "database.db", "missing.txt"};
+  for (const string &name : names) {
+    vector<int> expected;
+    for (const File &file : m_dataList) {
+      if (file.getName() == name) {
+        expected.push_back(file.getDiskBlock());
+      }
+    }
+    sort(expected.begin(), expected.end());
+    if (newSys.findAll(name) != expected) {
+      return false;
+    }
+  }
+
+  // in a table that places files by name alone, every entry of the name
+  // index points at its file, findAll does not walk the probe sequence
+  if (probing != QUADRATIC && probing != DOUBLEHASH && probing != LINEAR) {
+    return true;
+  }
+  for (size_t pos = 0; pos < newSys.m_namesCap; pos++) {
+    const NameEntry &entry = newSys.m_names[pos];
+    bool found = (entry.m_block == 0);
+    for (int table = 1; table <= 2 && !found; table++) {
+      const Slot *slots = (table == 1) ? newSys.m_currentTable : newSys.m_oldTable;
+      const unsigned char *ctrl = (table == 1) ? newSys.m_currCtrl : newSys.m_oldCtrl;
+      size_t cap = (table == 1) ? newSys.m_currentCap : newSys.m_oldCap;
+      found = slots != nullptr && entry.m_slot < cap &&
+              !(ctrl[entry.m_slot] & 0x80) &&
+              slots[entry.m_slot].m_hash == entry.m_hash &&
+              slots[entry.m_slot].m_diskBlock == entry.m_block;
+    }
+    if (!found) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Name: testGroupedStore
+// Desc: Tests a GROUPSTORE file system, where files with the same name share
+// one slot. Files with numNames different names are inserted until the table
+// rehashes, then some are removed and moved to new blocks. Every file must be
+// found, findAll must return the blocks of each name and the table must hold
+// one slot per stored name. Parameters:
+//    - filesysSize: the size of the FileSys object to be created.
+//    - numdataPoints: the number of files to be inserted.
+//    - numNames: the number of different names of the files.
+//    - probing: the probing technique to be used by the FileSys object.
+// Postconditions:
+//    - Returns true if the grouped file system matches the data list.
+bool Tester::testGroupedStore(int filesysSize, int numdataPoints, int numNames,
+                              prob_t probing) {
+  Random RndID(DISKMIN, DISKMAX);
+  FileSys newSys(filesysSize, hashCode, probing, PRIMECAP, GROUPSTORE);
+  for (int i = 0; i < numdataPoints; i++) {
+    File file("dir/file" + to_string(i % numNames) + ".txt",
+              RndID.getRandNum(), true);
+    bool isNew = find(m_dataList.begin(), m_dataList.end(), file) ==
+                 m_dataList.end();
+    if (newSys.insert(file) != isNew) {
+      return false;
+    }
+    if (isNew) {
+      m_dataList.push_back(file);
+    }
+  }
+  // a duplicate file is rejected, the group already holds its block
+  if (newSys.insert(m_dataList[0]) ||
+      newSys.emplace(m_dataList[1].getName(), m_dataList[1].getDiskBlock())) {
+    return false;
+  }
+
+  // some names lose all their files, which deletes their slots
+  for (int i = (int)m_dataList.size() - 1; i >= 0; i--) {
+    if (m_dataList[i].getName() == "dir/file0.txt" ||
+        m_dataList[i].getName() == "dir/file1.txt" || i % 7 == 0) {
+      if (!newSys.remove(m_dataList[i]) || newSys.remove(m_dataList[i])) {
+        return false;
+      }
+      m_dataList.erase(m_dataList.begin() + i);
+    }
+  }
+  // a few files move to blocks no other file uses
+  for (int i = 0; i < 10; i++) {
+    if (!newSys.updateDiskBlock(m_dataList[i], DISKMAX - i)) {
+      return false;
+    }
+    m_dataList[i].setDiskBlock(DISKMAX - i);
+  }
+
+  vector<string> names;
+  for (const File &file : m_dataList) {
+    if (!(newSys.getFile(file.getName(), file.getDiskBlock()) == file)) {
+      return false;
+    }
+    if (find(names.begin(), names.end(), file.getName()) == names.end()) {
+      names.push_back(file.getName());
+    }
+  }
+  for (const string &name : names) {
+    vector<int> expected;
+    for (const File &file : m_dataList) {
+      if (file.getName() == name) {
+        expected.push_back(file.getDiskBlock());
+      }
+    }
+    sort(expected.begin(), expected.end());
+    if (newSys.findAll(name) != expected) {
+      return false;
+    }
+  }
+  if (newSys.findFile("dir/file0.txt", m_dataList[0].getDiskBlock()) !=
+          nullptr ||
+      !newSys.findAll("dir/file1.txt").empty()) {
+    return false;
+  }
+
+  // the table must have grown, and it holds a slot per name
+  size_t stored = newSys.m_currentSize;
+  if (newSys.m_oldTable != nullptr) {
+    stored += newSys.m_oldSize;
+  }
+  return newSys.m_currentCap > (size_t)filesysSize && stored == names.size();
+}
+
+// Name: testBlockIndex
+// Desc: Tests getFileByBlock and blockOwners. Files with a few names and
+// their own blocks are inserted until the table migrates. The block index is
+// built from the first half of them by the first lookup, after that every
+// block is looked up while the migration may still be in progress. Then files
+// are removed and moved, and two files share a block. Parameters:
+//    - filesysSize: the size of the FileSys object to be created.
+//    - numdataPoints: the number of files to be inserted.
+//    - hash: the hash function to be used by the FileSys object.
+//    - probing: the probing technique to be used by the FileSys object.
+//    - storeMode: FILESTORE or GROUPSTORE.
+// Postconditions:
+//    - Returns true if every block leads to the file stored under it.
+bool Tester::testBlockIndex(int filesysSize, int numdataPoints, hash_fn hash,
+                            prob_t probing, store_t storeMode) {
+  FileSys newSys(filesysSize, hash, probing, PRIMECAP, storeMode);
+  bool migrated = false;
+  for (int i = 0; i < numdataPoints; i++) {
+    File file("file" + to_string(i % 100) + ".txt", DISKMIN + 3 * i, true);
+    if (!newSys.insert(file)) {
+      return false;
+    }
+    m_dataList.push_back(file);
+    migrated = migrated || newSys.m_oldTable != nullptr;
+    if (i < numdataPoints / 2) {
+      if (newSys.m_owners != nullptr) {
+        return false; // nothing looked up a block yet
+      }
+      continue;
+    }
+    // the files of the old table are found too
+    if (!(newSys.getFileByBlock(file.getDiskBlock()) == file) ||
+        !(newSys.getFileByBlock(m_dataList[i / 2].getDiskBlock()) ==
+          m_dataList[i / 2])) {
+      return false;
+    }
+  }
+
+  for (int i = 0; i < numdataPoints; i += 5) {
+    if (!newSys.remove(m_dataList[i])) {
+      return false;
+    }
+  }
+  for (int i = 1; i < numdataPoints; i += 5) {
+    if (!newSys.updateDiskBlock(m_dataList[i], DISKMAX - i)) {
+      return false;
+    }
+    m_dataList[i].setDiskBlock(DISKMAX - i);
+  }
+  for (int i = 0; i < numdataPoints; i++) {
+    const File &file = m_dataList[i];
+    bool removed = i % 5 == 0;
+    if (newSys.blockOwners(file.getDiskBlock()) != !removed ||
+        !(newSys.getFileByBlock(file.getDiskBlock()) ==
+          (removed ? File() : file))) {
+      return false;
+    }
+  }
+
+  // a second file under a block makes the owner ambiguous until one goes
+  File shared("shared.txt", m_dataList[2].getDiskBlock(), true);
+  if (!newSys.insert(shared) ||
+      newSys.blockOwners(shared.getDiskBlock()) != 2 ||
+      newSys.getFileByBlock(shared.getDiskBlock()).getUsed() ||
+      !newSys.remove(m_dataList[2]) ||
+      !(newSys.getFileByBlock(shared.getDiskBlock()) == shared)) {
+    return false;
+  }
+  return migrated && newSys.blockOwners(DISKMIN - 1) == 0 &&
+         !newSys.getFileByBlock(DISKMIN + 1).getUsed();
+}
+
+// Name: testBlockAllocator
+// Desc: Tests create, freeBlocks and fragmentation. Files are created on
+// consecutive free blocks, then every other one is removed and the free
+// block count and fragmentation are compared with a count over all blocks.
+// A full disk is simulated by marking every block used. Parameters:
+//    - numdataPoints: the number of files to be created.
+//    - probing: the probing technique to be used by the FileSys object.
+// Postconditions:
+//    - Returns true if the allocator hands out free blocks only.
+bool Tester::testBlockAllocator(int numdataPoints, prob_t probing) {
+  FileSys newSys(MINPRIME, hashCode, probing);
+  if (newSys.freeBlocks() != (size_t)NUMBLOCKS ||
+      newSys.fragmentation() != 0.0) {
+    return false;
+  }
+  // a block the caller picks is used as well
+  if (!newSys.insert(File("picked.txt", DISKMIN + 1, true))) {
+    return false;
+  }
+  for (int i = 0; i < numdataPoints; i++) {
+    string name = "file" + to_string(i % 10) + ".txt";
+    int block = newSys.create(name);
+    int expected = DISKMIN + ((i == 0) ? 0 : i + 1);
+    if (block != expected ||
+        !(newSys.getFileByBlock(block) == File(name, block, true))) {
+      return false;
+    }
+    m_dataList.push_back(File(name, block, true));
+  }
+  for (int i = 0; i < numdataPoints; i += 2) {
+    if (!newSys.remove(m_dataList[i])) {
+      return false;
+    }
+  }
+
+  // count the free blocks and the largest free run block by block
+  size_t free = 0;
+  size_t largest = 0;
+  size_t run = 0;
+  for (int block = DISKMIN; block <= DISKMAX; block++) {
+    if (newSys.blockOwners(block) == 0) {
+      free++;
+      run++;
+      largest = max(largest, run);
+    } else {
+      run = 0;
+    }
+  }
+  float expected = 1.0 - (float)largest / free;
+  if (newSys.freeBlocks() != free ||
+      fabs(newSys.fragmentation() - expected) > 1e-6 ||
+      newSys.fragmentation() <= 0.0) {
+    return false;
+  }
+
+  // with every block used create fails, a freed block is found again after
+  // the search wraps around
+  for (int block = DISKMIN; block <= DISKMAX; block++) {
+    if (newSys.blockOwners(block) == 0) {
+      newSys.markBlock(block, true);
+    }
+  }
+  if (newSys.freeBlocks() != 0 || newSys.create("full.txt") != 0) {
+    return false;
+  }
+  newSys.markBlock(DISKMIN, false);
+  int block = newSys.create("last.txt");
+  return block == DISKMIN &&
+         newSys.getFileByBlock(block) == File("last.txt", block, true);
+}
+
+// Name: testDirTree
+// Desc: Tests mkdir, list and rename of a DirTree. A small tree is built, one
+// directory gets numdataPoints files so its tables rehash, and directories
+// and files are renamed. Every file must be found under its new path, and a
+// listing must hold exactly the entries of its directory. Parameters:
+//    - numdataPoints: the number of files in the large directory.
+//    - probing: the probing technique of the directory tables.
+// Postconditions:
+//    - Returns true if the tree matches the expected paths.
+bool Tester::testDirTree(int numdataPoints, prob_t probing) {
+  DirTree tree(hashCode, probing);
+  if (!tree.mkdir("logs") || !tree.mkdir("/logs/2026-10/") ||
+      !tree.mkdir("logs/2026-10/service") || !tree.mkdir("src") ||
+      tree.mkdir("logs") || tree.mkdir("missing/dir") || tree.mkdir("/")) {
+    return false;
+  }
+  for (int i = 0; i < numdataPoints; i++) {
+    string path = "logs/2026-10/service/worker-" + to_string(i % 50) + ".log";
+    if (!tree.insert(path, DISKMIN + i)) {
+      return false;
+    }
+  }
+  // a name can not be both a file and a directory
+  if (!tree.insert("src/main.cpp", DISKMIN) ||
+      !tree.insert("src/main.cpp", DISKMIN + 1) ||
+      tree.insert("src/main.cpp", DISKMIN) || tree.insert("logs", DISKMIN) ||
+      tree.mkdir("src/main.cpp") || tree.insert("missing/a.txt", DISKMIN)) {
+    return false;
+  }
+
+  vector<string> service = tree.list("logs/2026-10/service");
+  vector<string> root = tree.list("");
+  sort(root.begin(), root.end());
+  if (service.size() != 50 || root != vector<string>({"logs/", "src/"}) ||
+      tree.list("src") != vector<string>({"main.cpp"}) ||
+      !tree.list("missing").empty()) {
+    return false;
+  }
+
+  // the directory moves with everything below it
+  if (tree.rename("logs", "logs/2026-10/service/old") ||
+      !tree.rename("logs/2026-10", "src/archive") ||
+      !tree.list("logs").empty() ||
+      tree.list("src/archive") != vector<string>({"service/"})) {
+    return false;
+  }
+  for (int i = 0; i < numdataPoints; i++) {
+    string name = "worker-" + to_string(i % 50) + ".log";
+    if (tree.findFile("src/archive/service/" + name, DISKMIN + i) == nullptr ||
+        tree.findFile("logs/2026-10/service/" + name, DISKMIN + i) !=
+            nullptr) {
+      return false;
+    }
+  }
+
+  // the files of a name move with all their blocks
+  if (!tree.rename("src/main.cpp", "logs/main.cpp") ||
+      tree.rename("src/main.cpp", "logs/other.cpp") ||
+      tree.findFile("logs/main.cpp", DISKMIN) == nullptr ||
+      tree.findFile("logs/main.cpp", DISKMIN + 1) == nullptr ||
+      !tree.remove("logs/main.cpp", DISKMIN) ||
+      tree.findFile("logs/main.cpp", DISKMIN) != nullptr) {
+    return false;
+  }
+  // the directory tables never look up a block, so no block index is built
+  for (const DirTree::Dir &dir : tree.m_dirs) {
+    if (dir.m_files != nullptr &&
+        (dir.m_files->m_owners != nullptr || dir.m_subdirs->m_owners != nullptr)) {
+      return false;
+    }
+  }
+  root = tree.list("/");
+  sort(root.begin(), root.end());
+  return root == vector<string>({"logs/", "src/"}) &&
+         tree.list("logs") == vector<string>({"main.cpp"});
+}
+
+// Name: testDirTreeFull
+// Desc: Tests mkdir and rename into a directory whose tables have no room
+// left. Every name has the same hash, so a CUCKOO or HOPSCOTCH table refuses
+// names once the buckets a hash can use are full. A refused mkdir must not
+// leave a directory behind, and a refused rename must leave the entry at its
+// old path. Parameters:
+//    - probing: CUCKOO or HOPSCOTCH.
+// Postconditions:
+//    - Returns true if nothing is lost or left behind by the refusals.
+bool Tester::testDirTreeFull(prob_t probing) {
+  DirTree tree(sameHash, probing);
+  if (!tree.mkdir("sub") || !tree.mkdir("dir") ||
+      !tree.insert("f0", DISKMIN) || !tree.insert("f0", DISKMIN + 1)) {
+    return false;
+  }
+  int files = 0;
+  while (files < 100 && tree.insert("sub/file" + to_string(files), DISKMIN)) {
+    files++;
+  }
+  int dirs = 0;
+  while (dirs < 100 && tree.mkdir("sub/dir" + to_string(dirs))) {
+    dirs++;
+  }
+  // the refused mkdir made no tables
+  if (files == 100 || dirs == 100 || tree.m_dirs.size() != (size_t)dirs + 3) {
+    return false;
+  }
+
+  if (tree.rename("f0", "sub/new") || tree.rename("dir", "sub/new") ||
+      tree.findFile("f0", DISKMIN) == nullptr ||
+      tree.findFile("f0", DISKMIN + 1) == nullptr ||
+      tree.findFile("sub/new", DISKMIN) != nullptr ||
+      tree.m_dirs[2].m_parent != 0 || !tree.insert("dir/a.txt", DISKMIN)) {
+    return false;
+  }
+  vector<string> root = tree.list("");
+  sort(root.begin(), root.end());
+  return root == vector<string>({"dir/", "f0", "sub/"}) &&
+         tree.list("sub").size() == (size_t)(files + dirs);
+}
+
+// Name: testOrderedIndex
+// Desc: Tests scanPrefix with and without the ordered name index. Half of the
+// files are inserted before the index is enabled and half after, then every
+// name of one directory is removed, which empties whole leaves of the tree,
+// and files move to new blocks. The scans must list exactly the files of the
+// data list with the prefix, in order. Parameters:
+//    - numdataPoints: the number of files to be inserted.
+//    - probing: the probing technique to be used by the FileSys object.
+//    - storeMode: FILESTORE or GROUPSTORE.
+// Postconditions:
+//    - Returns true if every scan matches the sorted data list.
+bool Tester::testOrderedIndex(int numdataPoints, prob_t probing,
+                              store_t storeMode) {
+  FileSys newSys(MINPRIME, hashCode, probing, PRIMECAP, storeMode);
+  Random RndID(DISKMIN, DISKMAX);
+  vector<string> dirs = {"a/", "b/", "b/c/", "logs/2026-10/", "logs/2026-11/"};
+  for (int i = 0; i < numdataPoints; i++) {
+    if (i == numdataPoints / 2) {
+      newSys.enableOrderedIndex();
+    }
+    File file(dirs[i % 5] + "file" + to_string(i % 97), RndID.getRandNum(),
+              true);
+    if (newSys.insert(file)) {
+      m_dataList.push_back(file);
+    }
+  }
+  for (int i = (int)m_dataList.size() - 1; i >= 0; i--) {
+    if (m_dataList[i].getName().compare(0, 2, "b/") == 0) {
+      if (!newSys.remove(m_dataList[i])) {
+        return false;
+      }
+      m_dataList.erase(m_dataList.begin() + i);
+    }
+  }
+  for (int i = 0; i < 50; i++) {
+    if (!newSys.updateDiskBlock(m_dataList[i], DISKMAX - i)) {
+      return false;
+    }
+    m_dataList[i].setDiskBlock(DISKMAX - i);
+  }
+  if (newSys.m_ordered->size() != m_dataList.size()) {
+    return false;
+  }
+
+  vector<string> prefixes = {"", "a/", "b/", "logs/", "logs/2026-11/file1",
+                             "logs/2026-12", "zzz"};
+  for (const string &prefix : prefixes) {
+    vector<pair<string, int>> expected;
+    for (const File &file : m_dataList) {
+      if (file.getName().compare(0, prefix.size(), prefix) == 0) {
+        expected.push_back({file.getName(), file.getDiskBlock()});
+      }
+    }
+    sort(expected.begin(), expected.end());
+
+    vector<pair<string, int>> scanned;
+    newSys.scanPrefix(prefix, [&scanned](const string &name, int block) {
+      scanned.push_back({name, block});
+    });
+    // the table without the index sorts the files of the prefix
+    NameTree *ordered = newSys.m_ordered;
+    newSys.m_ordered = nullptr;
+    vector<pair<string, int>> collected;
+    newSys.scanPrefix(prefix, [&collected](const string &name, int block) {
+      collected.push_back({name, block});
+    });
+    newSys.m_ordered = ordered;
+    if (scanned != expected || collected != expected) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Name: testLiveIterator
+// Desc: Tests the walk over the stored files during a migration. Files are
+// inserted until a rehash starts, then the table is walked while files are
+// inserted and removed between steps, which would move files out of the old
+// table without the pause. Policies that move files within a table on
+// insert are walked without changes. Parameters:
+//    - numdataPoints: the number of files to be inserted before the walk.
+//    - probing: the probing technique to be used by the FileSys object.
+//    - storeMode: FILESTORE or GROUPSTORE.
+// Postconditions:
+//    - Returns true if every file stored for the whole walk is visited once,
+//    no file is visited twice, and the migration ends after the walk.
+bool Tester::testLiveIterator(int numdataPoints, prob_t probing,
+                              store_t storeMode) {
+  FileSys newSys(MINPRIME, hashCode, probing, PRIMECAP, storeMode);
+  // in GROUPSTORE every name is stored under four blocks
+  int perName = (storeMode == GROUPSTORE) ? 4 : 1;
+  int next = 0;
+  while (next < numdataPoints || newSys.m_oldTable == nullptr) {
+    File file("file" + to_string(next / perName), DISKMIN + next, true);
+    if (!newSys.insert(file)) {
+      return false;
+    }
+    m_dataList.push_back(file);
+    next++;
+  }
+
+  bool change = (probing != ROBINHOOD && probing != CUCKOO &&
+                 probing != HOPSCOTCH);
+  map<pair<string, int>, int> visits;
+  int step = 0;
+  for (FileSys::LiveIterator it = newSys.begin(); it != newSys.end(); ++it) {
+    visits[{it.getName(), it.getDiskBlock()}]++;
+    if (!change) {
+      continue;
+    }
+    // a file removed between steps may or may not have been visited
+    if (step % 3 == 0 && !m_dataList.empty()) {
+      if (!newSys.remove(m_dataList.back())) {
+        return false;
+      }
+      m_dataRemoved.push_back(m_dataList.back());
+      m_dataList.pop_back();
+    }
+    File file("file" + to_string(next / perName), DISKMIN + next, true);
+    if (newSys.insert(file)) {
+      m_dataRemoved.push_back(file); // inserted during the walk
+    }
+    next++;
+    step++;
+  }
+  if (newSys.m_iterators != 0) {
+    return false;
+  }
+  for (const File &file : m_dataList) {
+    if (visits[{file.getName(), file.getDiskBlock()}] != 1) {
+      return false;
+    }
+  }
+  size_t stored = m_dataList.size();
+  for (const pair<const pair<string, int>, int> &visit : visits) {
+    if (visit.second != 1) {
+      return false;
+    }
+  }
+  if (!change && visits.size() != stored) {
+    return false;
+  }
+
+  // the migration goes on after the walk, and forEach sees the same files
+  for (int i = 0; i < 20 && newSys.m_oldTable != nullptr; i++) {
+    newSys.getFile("file0", DISKMIN);
+    newSys.insert(File("after" + to_string(i), DISKMAX - i, true));
+  }
+  size_t walked = 0;
+  for (File file : newSys) {
+    if (file.getUsed()) {
+      walked++;
+    }
+  }
+  size_t each = 0;
+  newSys.forEach([&each](const string &, int) { each++; });
+  // a GROUPSTORE slot holds several files
+  return newSys.m_oldTable == nullptr && walked == each &&
+         (storeMode == GROUPSTORE || each == newSys.getNumData());
+}
+
+// Name: testWalkInserts
+// Desc: Tests many inserts while a walk holds the migration. The table starts
+// a rehash during the walk, and its new table fills up since no file moves
+// into it; from then on an insert must be refused instead of overfilling it.
+// Parameters:
+//    - numdataPoints: the number of files inserted during the walk.
+//    - probing: the probing technique to be used by the FileSys object.
+//    - storeMode: FILESTORE or GROUPSTORE.
+// Postconditions:
+//    - Returns true if the tables never pass the load limit, every file
+//    stored before the walk is visited once, every accepted file is found,
+//    and the refused files are stored once the walk ends.
+bool Tester::testWalkInserts(int numdataPoints, prob_t probing,
+                             store_t storeMode) {
+  FileSys newSys(MINPRIME, hashCode, probing, PRIMECAP, storeMode);
+  float limit = (probing == HOPSCOTCH) ? HOPMAXLOAD : MAXLOAD;
+  for (int i = 0; i < 40; i++) {
+    File file("file" + to_string(i), DISKMIN + i, true);
+    if (!newSys.insert(file)) {
+      return false;
+    }
+    m_dataList.push_back(file);
+  }
+
+  vector<File> refused;
+  map<pair<string, int>, int> visits;
+  FileSys::LiveIterator it = newSys.begin();
+  for (int i = 40; i < 40 + numdataPoints; i++) {
+    string name = "file" + to_string(i);
+    if (newSys.emplace(name, DISKMIN + i)) {
+      m_dataList.push_back(File(name, DISKMIN + i, true));
+    } else {
+      refused.push_back(File(name, DISKMIN + i, true));
+    }
+    if (newSys.m_currentSize + newSys.m_oldSize >
+        (size_t)(limit * newSys.m_currentCap) + 1) {
+      return false;
+    }
+  }
+  for (; it != newSys.end(); ++it) {
+    visits[{it.getName(), it.getDiskBlock()}]++;
+  }
+  for (int i = 0; i < 40; i++) {
+    if (visits[{m_dataList[i].getName(), m_dataList[i].getDiskBlock()}] != 1) {
+      return false;
+    }
+  }
+  if (refused.empty() || newSys.m_iterators != 0) {
+    return false;
+  }
+
+  // the walk ended, the refused files are stored and the tables grow again
+  for (const File &file : refused) {
+    if (!newSys.insert(file)) {
+      return false;
+    }
+    m_dataList.push_back(file);
+  }
+  for (const File &file : m_dataList) {
+    if (newSys.findFile(file.getName(), file.getDiskBlock()) == nullptr) {
+      return false;
+    }
+  }
+  return newSys.m_currentSize + newSys.m_oldSize <=
+         (size_t)(limit * newSys.m_currentCap) + 1;
+}
+
+// Name: testWalkBatch
+// Desc: Tests a batch larger than the room left in a table whose migration a
+// walk holds. The table cannot grow before the batch, the files must be
+// stored one by one and the ones it has no room for refused. Parameters:
+//    - numdataPoints: the number of files in the batch.
+//    - probing: the probing technique to be used by the FileSys object.
+//    - storeMode: FILESTORE or GROUPSTORE.
+//    - bulk: true to store the batch with bulkLoad, false with insertBatch.
+// Postconditions:
+//    - Returns true if the tables never pass the load limit, the count
+//    returned is the number of batch files found, and the batch is stored
+//    whole once the walk ends.
+bool Tester::testWalkBatch(int numdataPoints, prob_t probing,
+                           store_t storeMode, bool bulk) {
+  FileSys newSys(MINPRIME, hashCode, probing, PRIMECAP, storeMode);
+  float limit = (probing == HOPSCOTCH) ? HOPMAXLOAD : MAXLOAD;
+  int stored = 0;
+  while (newSys.m_oldTable == nullptr) {
+    File file("file" + to_string(stored), DISKMIN + stored, true);
+    if (!newSys.insert(file)) {
+      return false;
+    }
+    m_dataList.push_back(file);
+    stored++;
+  }
+
+  vector<File> files;
+  for (int i = stored; i < stored + numdataPoints; i++) {
+    files.push_back(File("file" + to_string(i), DISKMIN + i, true));
+  }
+  FileSys::LiveIterator it = newSys.begin();
+  size_t first = bulk ? newSys.bulkLoad(files) : newSys.insertBatch(files);
+  if (first == 0 || first >= files.size() ||
+      newSys.m_currentSize + newSys.m_oldSize >
+          (size_t)(limit * newSys.m_currentCap) + 1) {
+    return false;
+  }
+  size_t found = 0;
+  for (const File &file : files) {
+    if (newSys.findFile(file.getName(), file.getDiskBlock()) != nullptr) {
+      found++;
+    }
+  }
+  if (found != first) {
+    return false;
+  }
+  while (it != newSys.end()) {
+    ++it;
+  }
+
+  // the walk ended, the refused files are stored after a rehash
+  vector<File> copies(files);
+  size_t second = bulk ? newSys.bulkLoad(std::move(copies))
+                       : newSys.insertBatch(files);
+  if (first + second != files.size()) {
+    return false;
+  }
+  m_dataList.insert(m_dataList.end(), files.begin(), files.end());
+  for (const File &file : m_dataList) {
+    if (newSys.findFile(file.getName(), file.getDiskBlock()) == nullptr) {
+      return false;
+    }
+  }
+  return newSys.m_currentSize + newSys.m_oldSize <=
+         (size_t)(limit * newSys.m_currentCap) + 1;
+}
+
+// Name: testBulkLoad
+// Desc: Tests bulkLoad into a table that is in the middle of a migration. The
+// loaded files repeat every file once, some of them are already stored and
+// some have a block out of range. Parameters:
+//    - numdataPoints: the number of distinct files to be loaded.
+//    - probing: the probing technique to be used by the FileSys object.
+//    - storeMode: FILESTORE or GROUPSTORE.
+// Postconditions:
+//    - Returns true if bulkLoad stores every new valid file once, finishes the
+//    migration, leaves the load below the limit, and the table holds the same
+//    files as a table filled by insert.
+bool Tester::testBulkLoad(int numdataPoints, prob_t probing,
+                          store_t storeMode) {
+  FileSys newSys(MINPRIME, hashCode, probing, PRIMECAP, storeMode);
+  FileSys oneByOne(MINPRIME, hashCode, probing, PRIMECAP, storeMode);
+  int perName = (storeMode == GROUPSTORE) ? 4 : 1;
+  int stored = 0;
+  while (newSys.m_oldTable == nullptr) {
+    File file("file" + to_string(stored / perName), DISKMIN + stored, true);
+    if (!newSys.insert(file) || !oneByOne.insert(file)) {
+      return false;
+    }
+    stored++;
+  }
+
+  // every file twice, the first 10 of them are stored already
+  vector<File> files;
+  for (int i = stored - 10; i < stored + numdataPoints; i++) {
+    File file("file" + to_string(i / perName), DISKMIN + i, true);
+    files.push_back(file);
+    files.push_back(file);
+    m_dataList.push_back(file);
+  }
+  files.push_back(File("file0", DISKMAX + 1, true));
+  files.push_back(File("file0", DISKMIN - 1, true));
+  if (newSys.bulkLoad(files) != (size_t)numdataPoints ||
+      newSys.m_oldTable != nullptr || newSys.lambda() > MAXLOAD) {
+    return false;
+  }
+  for (const File &file : files) {
+    oneByOne.insert(file);
+  }
+
+  for (const File &file : m_dataList) {
+    if (newSys.findFile(file.getName(), file.getDiskBlock()) == nullptr ||
+        newSys.blockOwners(file.getDiskBlock()) != 1) {
+      return false;
+    }
+  }
+  vector<pair<string, int>> loaded;
+  vector<pair<string, int>> inserted;
+  newSys.forEach([&loaded](const string &name, int block) {
+    loaded.push_back({name, block});
+  });
+  oneByOne.forEach([&inserted](const string &name, int block) {
+    inserted.push_back({name, block});
+  });
+  sort(loaded.begin(), loaded.end());
+  sort(inserted.begin(), inserted.end());
+  if (loaded != inserted || loaded.size() != (size_t)(stored + numdataPoints)) {
+    return false;
+  }
+
+  // the moved names end up in the slots, a second load stores nothing
+  vector<File> again(files.begin(), files.begin() + 100);
+  return newSys.bulkLoad(std::move(again), false) == 0 &&
+         newSys.findAll("file0").size() == (size_t)perName;
+}
+
+// Name: testFindFiles
+// Desc: Tests the batch lookup during a migration. The batch mixes stored
+// files from both tables with files that are not stored, and its length is
+// not a multiple of FINDAHEAD. Parameters:
+//    - numdataPoints: the number of files to be inserted before the batch.
+//    - probing: the probing technique to be used by the FileSys object.
+//    - storeMode: FILESTORE or GROUPSTORE.
+// Postconditions:
+//    - Returns true if every result of findFiles, for File objects and for
+//    keys, is the result of findFile.
+bool Tester::testFindFiles(int numdataPoints, prob_t probing,
+                           store_t storeMode) {
+  FileSys newSys(MINPRIME, hashCode, probing, PRIMECAP, storeMode);
+  int perName = (storeMode == GROUPSTORE) ? 4 : 1;
+  int next = 0;
+  while (next < numdataPoints || newSys.m_oldTable == nullptr) {
+    File file("file" + to_string(next / perName), DISKMIN + next, true);
+    if (!newSys.insert(file)) {
+      return false;
+    }
+    m_dataList.push_back(file);
+    next++;
+  }
+
+  vector<File> batch;
+  for (int i = 0; i < next; i += 3) {
+    batch.push_back(m_dataList[i]);
+    batch.push_back(File(m_dataList[i].getName(), DISKMAX - i, true));
+  }
+  batch.push_back(File("missing", DISKMIN, true));
+  vector<const Slot *> found;
+  size_t hits = newSys.findFiles(batch, found);
+  if (found.size() != batch.size() || hits != (size_t)(next + 2) / 3) {
+    return false;
+  }
+  for (size_t i = 0; i < batch.size(); i++) {
+    if (found[i] != newSys.findFile(batch[i].getName(),
+                                    batch[i].getDiskBlock())) {
+      return false;
+    }
+  }
+
+  // the keys view names that are not std::strings
+  const char names[] = "file0 file1 missing";
+  FileKey keys[3] = {{string_view(names, 5), m_dataList[0].getDiskBlock()},
+                     {string_view(names + 6, 5), DISKMAX},
+                     {string_view(names + 12, 7), DISKMIN}};
+  const Slot *keyFound[3];
+  if (newSys.findFiles(keys, 3, keyFound) != 1 ||
+      keyFound[0] != newSys.findFile("file0", m_dataList[0].getDiskBlock()) ||
+      keyFound[0] == nullptr || keyFound[1] != nullptr ||
+      keyFound[2] != nullptr) {
+    return false;
+  }
+
+  // a batch shorter than FINDAHEAD and an empty one
+  vector<File> small(batch.begin(), batch.begin() + 3);
+  vector<File> none;
+  return newSys.findFiles(small, found) == 2 && found.size() == 3 &&
+         newSys.findFiles(none, found) == 0 && found.empty();
+}
+
+// Name: testBatches
+// Desc: Tests insertBatch and removeBatch against single inserts and removes.
+// Every batch repeats some of its files and some files of the last batch,
+// and half of the files are removed again in batches. Parameters:
+//    - numdataPoints: the number of files to be inserted.
+//    - probing: the probing technique to be used by the FileSys object.
+//    - storeMode: FILESTORE or GROUPSTORE.
+// Postconditions:
+//    - Returns true if both tables store and remove the same files, no batch
+//    leaves the load above the limit, and the migrations end.
+bool Tester::testBatches(int numdataPoints, prob_t probing,
+                         store_t storeMode) {
+  FileSys newSys(MINPRIME, hashCode, probing, PRIMECAP, storeMode);
+  FileSys oneByOne(MINPRIME, hashCode, probing, PRIMECAP, storeMode);
+  int perName = (storeMode == GROUPSTORE) ? 4 : 1;
+  float limit = (probing == HOPSCOTCH) ? HOPMAXLOAD : MAXLOAD;
+  const int BATCH = 500;
+  for (int first = 0; first < numdataPoints; first += BATCH) {
+    vector<File> batch;
+    for (int i = max(0, first - 50); i < first + BATCH; i++) {
+      batch.push_back(File("file" + to_string(i / perName), DISKMIN + i, true));
+      if (i % 7 == 0) {
+        batch.push_back(batch.back());
+      }
+    }
+    size_t single = 0;
+    for (const File &file : batch) {
+      if (oneByOne.insert(file)) {
+        single++;
+        m_dataList.push_back(file);
+      }
+    }
+    if (newSys.insertBatch(batch) != single || newSys.lambda() > limit) {
+      return false;
+    }
+  }
+
+  vector<File> removed;
+  for (size_t i = 0; i < m_dataList.size(); i += 2) {
+    removed.push_back(m_dataList[i]);
+    oneByOne.remove(m_dataList[i]);
+  }
+  removed.push_back(File("missing", DISKMIN, true));
+  for (size_t first = 0; first < removed.size(); first += BATCH) {
+    vector<File> batch(removed.begin() + first,
+                       removed.begin() + min(removed.size(), first + BATCH));
+    size_t expected = batch.size() - (first + BATCH >= removed.size());
+    if (newSys.removeBatch(batch) != expected) {
+      return false;
+    }
+  }
+  // removing them again removes nothing
+  if (newSys.removeBatch(removed) != 0) {
+    return false;
+  }
+
+  for (int i = 0; i < 8 && newSys.m_oldTable != nullptr; i++) {
+    newSys.insertBatch(vector<File>());
+    newSys.getFile("file0", DISKMIN);
+    newSys.insertBatch(vector<File>(1, File("after", DISKMAX - i, true)));
+  }
+  newSys.removeBatch(vector<File>(1, File("after", DISKMAX, true)));
+  for (int i = 1; i < 8; i++) {
+    newSys.remove(File("after", DISKMAX - i, true));
+  }
+  vector<pair<string, int>> batched;
+  vector<pair<string, int>> single;
+  newSys.forEach([&batched](const string &name, int block) {
+    batched.push_back({name, block});
+  });
+  oneByOne.forEach([&single](const string &name, int block) {
+    single.push_back({name, block});
+  });
+  sort(batched.begin(), batched.end());
+  sort(single.begin(), single.end());
+  return newSys.m_oldTable == nullptr && batched == single &&
+         single.size() == m_dataList.size() - removed.size() + 1;
+}
+
+// Name: testReserve
+// Desc: Tests reserve and shrink_to_fit. A few files start a migration, the
+// table is reserved for numdataPoints files and filled with them, then 90%
+// of the files are removed and the table is shrunk. Parameters:
+//    - numdataPoints: the number of files to be inserted.
+//    - probing: the probing technique to be used by the FileSys object.
+//    - now: true for the synchronous mode.
+// Postconditions:
+//    - Returns true if filling the reserved table never starts a rehash, the
+//    shrunk table is the smallest one that holds the files under the load
+//    limit, and every file that was not removed is still found.
+bool Tester::testReserve(int numdataPoints, prob_t probing, bool now) {
+  FileSys newSys(MINPRIME, hashCode, probing);
+  float limit = (probing == HOPSCOTCH) ? HOPMAXLOAD : MAXLOAD;
+  int next = 0;
+  while (newSys.m_oldTable == nullptr) {
+    File file("file" + to_string(next), DISKMIN + next, true);
+    if (!newSys.insert(file)) {
+      return false;
+    }
+    m_dataList.push_back(file);
+    next++;
+  }
+
+  // the running migration is finished before the rehash of reserve
+  if (!newSys.reserve(numdataPoints, now) ||
+      newSys.m_currentCap * limit < numdataPoints ||
+      (now && newSys.m_oldTable != nullptr) ||
+      newSys.reserve(numdataPoints / 2, now)) {
+    return false;
+  }
+  size_t cap = newSys.m_currentCap;
+  for (; next < numdataPoints; next++) {
+    File file("file" + to_string(next), DISKMIN + next, true);
+    if (!newSys.insert(file) || newSys.m_currentCap != cap) {
+      return false;
+    }
+    m_dataList.push_back(file);
+  }
+  if (newSys.m_oldTable != nullptr) {
+    return false;
+  }
+
+  for (int i = (int)m_dataList.size() - 1; i >= 0; i--) {
+    if (i % 10 != 0) {
+      if (!newSys.remove(m_dataList[i])) {
+        return false;
+      }
+      m_dataList.erase(m_dataList.begin() + i);
+    }
+  }
+  if (!newSys.shrink_to_fit(now) || (now && newSys.m_oldTable != nullptr)) {
+    return false;
+  }
+  // the incremental mode ends its migration within four operations
+  for (int i = 0; i < 2; i++) {
+    File file("after", DISKMAX - i, true);
+    if (!newSys.insert(file) || !newSys.remove(file)) {
+      return false;
+    }
+  }
+  if (newSys.m_oldTable != nullptr ||
+      newSys.m_currentCap != newSys.fitCap(m_dataList.size()).m_cap ||
+      newSys.lambda() > limit || newSys.shrink_to_fit(now)) {
+    return false;
+  }
+  for (const File &file : m_dataList) {
+    if (newSys.findFile(file.getName(), file.getDiskBlock()) == nullptr) {
+      return false;
+    }
+  }
+  return newSys.getNumData() == m_dataList.size();
+}
+
+// Name: testMigrationStep
+// Desc: Tests the budget of a migration step while the table grows through
+// several rehashes, with a remove after every third insert. Parameters:
+//    - numdataPoints: the number of files to be inserted.
+//    - probing: the probing technique to be used by the FileSys object.
+//    - mode: the budget of a step.
+//    - amount: slots, files or nanoseconds of a step.
+// Postconditions:
+//    - Returns true if no step scans or moves more than its budget or twice
+//    the minimum of minTransfer, the files of both tables never fill the
+//    current table past its load limit during a migration, migrations last more than the four steps of the
+//    default, and every file that was not removed is found.
+bool Tester::testMigrationStep(int numdataPoints, prob_t probing,
+                               step_t mode, size_t amount) {
+  FileSys newSys(MINPRIME, hashCode, probing);
+  newSys.setMigrationStep(mode, amount);
+  float limit = (probing == HOPSCOTCH) ? HOPMAXLOAD : MAXLOAD;
+  size_t longest = 0;
+  size_t steps = 0;
+  for (int i = 0; i < numdataPoints; i++) {
+    const Slot *oldTable = newSys.m_oldTable;
+    size_t index = newSys.m_transferIndex;
+    size_t oldSize = newSys.m_oldSize;
+    // the insert lowers the inserts left, at most doubling minTransfer
+    size_t budget = max(amount, 2 * newSys.minTransfer());
+
+    File file("file" + to_string(i), DISKMIN + i, true);
+    if (!newSys.insert(file)) {
+      return false;
+    }
+    m_dataList.push_back(file);
+    if (i % 3 == 2) {
+      if (!newSys.remove(m_dataList[i - 1])) {
+        return false;
+      }
+      m_dataRemoved.push_back(m_dataList[i - 1]);
+    }
+
+    if (newSys.m_oldTable != nullptr &&
+        newSys.m_currentSize + newSys.m_oldSize >
+            (size_t)(limit * newSys.m_currentCap)) {
+      return false; // the migration would not end in time
+    }
+    if (oldTable == nullptr || newSys.m_oldTable != oldTable) {
+      steps = 0;
+      continue;
+    }
+    // the same migration went on, by an insert and maybe a remove, which
+    // may have taken its file from the old table
+    size_t ops = (i % 3 == 2) ? 2 : 1;
+    if ((mode == SLOTSTEP && newSys.m_transferIndex > index &&
+         newSys.m_transferIndex - index > ops * budget) ||
+        (mode == MOVESTEP &&
+         oldSize - newSys.m_oldSize > ops * budget + ops - 1)) {
+      return false;
+    }
+    steps += ops;
+    longest = max(longest, steps);
+  }
+  if (longest <= 4) {
+    return false;
+  }
+  for (size_t i = 0; i < m_dataList.size(); i++) {
+    bool removed = (i % 3 == 1 && i + 1 < m_dataList.size());
+    if ((newSys.findFile(m_dataList[i].getName(),
+                         m_dataList[i].getDiskBlock()) == nullptr) !=
+        removed) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Name: testBoundedFinish
+// Desc: Tests the operations that finish a running migration at once under a
+// small step budget: reserve, bulkLoad, insertBatch and the growth of a table
+// whose file finds no slot. Each one starts while a migration runs, a batch
+// holds more files than the current table has room for. Parameters:
+//    - numdataPoints: the number of files reserve makes room for.
+//    - probing: the probing technique to be used by the FileSys object.
+//    - mode: the budget of a step.
+//    - amount: slots, files or nanoseconds of a step.
+// Postconditions:
+//    - Returns true if every operation finishes the migration, stores all of
+//    its files under the load limit, and every file is found.
+bool Tester::testBoundedFinish(int numdataPoints, prob_t probing, step_t mode,
+                               size_t amount) {
+  FileSys newSys(MINPRIME, hashCode, probing);
+  newSys.setMigrationStep(mode, amount);
+  float limit = (probing == HOPSCOTCH) ? HOPMAXLOAD : MAXLOAD;
+  int next = 0;
+  // inserts files until a migration runs
+  auto migrate = [&]() {
+    while (newSys.m_oldTable == nullptr) {
+      File file("file" + to_string(next), DISKMIN + next, true);
+      if (!newSys.insert(file)) {
+        return false;
+      }
+      m_dataList.push_back(file);
+      next++;
+    }
+    return true;
+  };
+  // a batch of new files that does not fit under the load limit
+  auto makeBatch = [&]() {
+    vector<File> batch;
+    for (size_t i = 0; i < newSys.m_currentCap; i++, next++) {
+      batch.push_back(File("file" + to_string(next), DISKMIN + next, true));
+    }
+    m_dataList.insert(m_dataList.end(), batch.begin(), batch.end());
+    return batch;
+  };
+
+  if (!migrate() || !newSys.reserve(next + numdataPoints, true) ||
+      newSys.m_oldTable != nullptr) {
+    return false;
+  }
+  if (!migrate()) {
+    return false;
+  }
+  vector<File> batch = makeBatch();
+  if (newSys.bulkLoad(batch) != batch.size() ||
+      newSys.m_oldTable != nullptr || newSys.lambda() > limit ||
+      !migrate()) {
+    return false;
+  }
+  batch = makeBatch();
+  if (newSys.insertBatch(batch) != batch.size() ||
+      newSys.m_currentSize + newSys.m_oldSize >
+          (size_t)(limit * newSys.m_currentCap)) {
+    return false;
+  }
+  // the old migration ends before the current table turns into the old one
+  if (!migrate()) {
+    return false;
+  }
+  size_t cap = newSys.m_currentCap;
+  if (!newSys.growTable() || newSys.m_oldCap != cap) {
+    return false;
+  }
+
+  for (const File &file : m_dataList) {
+    if (newSys.findFile(file.getName(), file.getDiskBlock()) == nullptr) {
+      return false;
+    }
+  }
+  return newSys.getNumData() + newSys.m_oldSize == m_dataList.size();
+}
+
+int main() {
+  Tester aTester;
+
+  cout << "Testing for Normal Non Collision Handling" << endl;
+
+  if (aTester.testforNormalNonCollide(70, 25, hashCode, QUADRATIC,
+                                      NON_COLLIDE)) {
+    cout << "Testing test for Non Collision case passed!" << endl;
+
+  } else {
+    cout << "Testing for Non Collision Handling case failed!" << endl;
+  }
+  aTester.clearData();
+  cout << "Testing an Error case for getFile method Handling" << endl;
+
+  if (aTester.testFindError(200, 50, hashCode, DOUBLEHASH, NAMES_DB)) {
+    cout << "Testing an Error case for getFile method Handling passed !"
+         << endl;
+  } else {
+    cout << "Testing an Error case for getFile method case failed!" << endl;
+  }
+  aTester.clearData();
+  cout << "Testing a Normal case for getFile method Handling (Non-Collide)"
+       << endl;
+  if (aTester.testFindNonCollide(200, 50, hashCode, LINEAR, NON_COLLIDE)) {
+    cout << "Testing a Normal case for getFile method Handling passed !"
+         << endl;
+  } else {
+    cout << "Testing a Normal case for getFile method case failed!" << endl;
+  }
+  aTester.clearData();
+  cout << "Testing a Normal case for getFile method Handling (Collide)" << endl;
+
+  if (aTester.testFindColllide(101, 20, hashCode, QUADRATIC, COLLIDE)) {
+    cout << "Testing a Normal case for getFile method Handling passed !"
+         << endl;
+  } else {
+    cout << "Testing a Normal case for getFile method case failed!" << endl;
+  }
+
+  aTester.clearData();
+  cout << "Testing a Normal case for remove method Handling (Non-colliding)"
+       << endl;
+
+  if (aTester.testRemoveWithNonCollide(101, 30, hashCode, DOUBLEHASH,
+                                       NON_COLLIDE, 10)) {
+    cout << "Testing a Normal case for remove method Handling passed !" << endl;
+  } else {
+    cout << "Testing a Normal case for remove method Handling failed!" << endl;
+  }
+  aTester.clearData();
+  cout << "Testing error case for remove method " << endl;
+
+  if (aTester.testRemoveWithNonCollide(400, 100, hashCode, LINEAR, NAMES_DB,
+                                       10)) {
+    cout << "Testing error case passed !" << endl;
+  } else {
+    cout << "Testing error case failed!" << endl;
+  }
+  aTester.clearData();
+  cout << "Testing Normal case for remove method (Collide)" << endl;
+
+  if (aTester.testRemoveWithCollideNoRehash(400, 100, hashCode, LINEAR, COLLIDE,
+                                            10)) {
+    cout << "Testing Normal case for remove passed !" << endl;
+  } else {
+    cout << "Testing Normal case for remove failed!" << endl;
+  }
+
+  aTester.clearData();
+  cout << "Testing Normal case of triggering rehash method  " << endl;
+
+  if (aTester.testmidRehash(101, 49, hashCode, QUADRATIC, NAMES_DB)) {
+    cout << "Testing Normal case of  triggering rehash method passed !" << endl;
+  } else {
+    cout << "Testing Normal case of triggering rehash method failed!" << endl;
+  }
+  aTester.clearData();
+  cout << "Testing Normal case for rehash method with Completion" << endl;
+
+  if (aTester.testRehash(101, 55, hashCode, QUADRATIC, NAMES_DB)) {
+    cout << "Testing Normal case for rehash method passed !" << endl;
+  } else {
+    cout << "Testing Normal case for rehash method failed!" << endl;
+  }
+
+  aTester.clearData();
+  cout << "Testing Normal case of triggering rehash method with Deletion "
+          "factor > 0.8 "
+       << endl;
+  if (aTester.testmidRehashDeletion(101, 48, hashCode, LINEAR, COLLIDE, 35)) {
+    cout << "Testing Normal case for rehash method passed !" << endl;
+  } else {
+    cout << "Testing Normal case for rehash method failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing Normal case of rehash method with Deletion factor > 0.8 "
+          "with Completion "
+       << endl;
+  if (aTester.testRehashDeletionFactor(101, 47, hashCode, QUADRATIC, NAMES_DB,
+                                       39)) {
+    cout << "Testing Normal case for rehash method passed !" << endl;
+  } else {
+    cout << "Testing Normal case for rehash method failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing SWISS policy with control byte groups (Collide)" << endl;
+  if (aTester.testFindColllide(101, 40, hashCode, SWISS, COLLIDE)) {
+    cout << "Testing SWISS policy with control byte groups passed !" << endl;
+  } else {
+    cout << "Testing SWISS policy with control byte groups failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing SWISS policy control bytes with removals and rehash"
+       << endl;
+  if (aTester.testSwissControlBytes(101, 500, hashCode, NAMES_DB, 450)) {
+    cout << "Testing SWISS policy control bytes passed !" << endl;
+  } else {
+    cout << "Testing SWISS policy control bytes failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing that rehash reuses the cached hash values" << endl;
+  if (aTester.testHashOncePerInsert(1000, QUADRATIC) &&
+      aTester.testHashOncePerInsert(1000, SWISS)) {
+    cout << "Testing that rehash reuses the cached hash values passed !"
+         << endl;
+  } else {
+    cout << "Testing that rehash reuses the cached hash values failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing Normal case for updateDiskBlock method" << endl;
+  bool updated = aTester.testUpdateDiskBlock(101, 45, hashCode, LINEAR, NAMES_DB);
+  aTester.clearData();
+  updated = updated &&
+            aTester.testUpdateDiskBlock(101, 200, hashCode, SWISS, NAMES_DB);
+  if (updated) {
+    cout << "Testing Normal case for updateDiskBlock method passed !" << endl;
+  } else {
+    cout << "Testing Normal case for updateDiskBlock method failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing ROBINHOOD policy with backward shift deletion" << endl;
+  bool robinHood = aTester.testRobinHoodRemoval(101, 45, hashCode, NAMES_DB, 5);
+  aTester.clearData();
+  robinHood = robinHood && aTester.testRemoveWithNonCollide(
+                               101, 30, hashCode, ROBINHOOD, NON_COLLIDE, 10);
+  aTester.clearData();
+  robinHood = robinHood &&
+              aTester.testmidRehash(101, 51, hashCode, ROBINHOOD, NAMES_DB);
+  if (robinHood) {
+    cout << "Testing ROBINHOOD policy with backward shift deletion passed !"
+         << endl;
+  } else {
+    cout << "Testing ROBINHOOD policy with backward shift deletion failed!"
+         << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing CUCKOO policy with buckets and stash" << endl;
+  bool cuckoo = aTester.testCuckooPlacement(101, 800, hashCode, NAMES_DB, 600);
+  aTester.clearData();
+  cuckoo = cuckoo &&
+           aTester.testCuckooPlacement(101, 45, hashCode, COLLIDE, 20);
+  aTester.clearData();
+  cuckoo = cuckoo && aTester.testCuckooCycle();
+  aTester.clearData();
+  cuckoo = cuckoo && aTester.testEqualHash(CUCKOO, FILESTORE,
+                                           2 * CUCKOOWAYS + CUCKOOSTASH);
+  aTester.clearData();
+  cuckoo = cuckoo && aTester.testEqualHash(CUCKOO, GROUPSTORE,
+                                           2 * CUCKOOWAYS + CUCKOOSTASH);
+  if (cuckoo) {
+    cout << "Testing CUCKOO policy with buckets and stash passed !" << endl;
+  } else {
+    cout << "Testing CUCKOO policy with buckets and stash failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing HOPSCOTCH policy with neighborhood bitmaps" << endl;
+  bool hopscotch = aTester.testHopscotch(101, 80, hashCode, NAMES_DB, 30);
+  aTester.clearData();
+  hopscotch = hopscotch &&
+              aTester.testHopscotch(101, 800, hashCode, NAMES_DB, 600);
+  aTester.clearData();
+  hopscotch =
+      hopscotch && aTester.testEqualHash(HOPSCOTCH, FILESTORE, HOPRANGE);
+  aTester.clearData();
+  hopscotch =
+      hopscotch && aTester.testEqualHash(HOPSCOTCH, GROUPSTORE, HOPRANGE);
+  if (hopscotch) {
+    cout << "Testing HOPSCOTCH policy with neighborhood bitmaps passed !"
+         << endl;
+  } else {
+    cout << "Testing HOPSCOTCH policy with neighborhood bitmaps failed!"
+         << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing table growth past 100000 files" << endl;
+  if (aTester.testLargeCapacity(150000, QUADRATIC) &&
+      aTester.testLargeCapacity(150000, SWISS)) {
+    cout << "Testing table growth past 100000 files passed !" << endl;
+  } else {
+    cout << "Testing table growth past 100000 files failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing power of two capacities" << endl;
+  if (aTester.testPowerOfTwoCapacity(5000, QUADRATIC) &&
+      aTester.testPowerOfTwoCapacity(5000, DOUBLEHASH) &&
+      aTester.testPowerOfTwoCapacity(5000, LINEAR) &&
+      aTester.testPowerOfTwoCapacity(5000, SWISS) &&
+      aTester.testPowerOfTwoCapacity(5000, ROBINHOOD) &&
+      aTester.testPowerOfTwoCapacity(5000, CUCKOO) &&
+      aTester.testPowerOfTwoCapacity(5000, HOPSCOTCH)) {
+    cout << "Testing power of two capacities passed !" << endl;
+  } else {
+    cout << "Testing power of two capacities failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing the fast modulus of prime capacities" << endl;
+  if (aTester.testFastModulus()) {
+    cout << "Testing the fast modulus of prime capacities passed !" << endl;
+  } else {
+    cout << "Testing the fast modulus of prime capacities failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing the table of prime capacities" << endl;
+  if (aTester.testPrimeCapacities()) {
+    cout << "Testing the table of prime capacities passed !" << endl;
+  } else {
+    cout << "Testing the table of prime capacities failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing string_view hasher functors" << endl;
+  if (aTester.testHasherFunctor(3000, QUADRATIC) &&
+      aTester.testHasherFunctor(3000, SWISS)) {
+    cout << "Testing string_view hasher functors passed !" << endl;
+  } else {
+    cout << "Testing string_view hasher functors failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing lookups without heap allocations" << endl;
+  if (aTester.testZeroCopyLookup(2000, QUADRATIC) &&
+      aTester.testZeroCopyLookup(2000, SWISS) &&
+      aTester.testZeroCopyLookup(2000, CUCKOO)) {
+    cout << "Testing lookups without heap allocations passed !" << endl;
+  } else {
+    cout << "Testing lookups without heap allocations failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing move insert and emplace" << endl;
+  if (aTester.testMoveInsert(200, QUADRATIC) &&
+      aTester.testMoveInsert(200, ROBINHOOD) &&
+      aTester.testMoveInsert(200, HOPSCOTCH)) {
+    cout << "Testing move insert and emplace passed !" << endl;
+  } else {
+    cout << "Testing move insert and emplace failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing findAll for names stored under many blocks" << endl;
+  bool findAll = aTester.testFindAll(101, 800, hashCode, QUADRATIC, 300);
+  aTester.clearData();
+  findAll = findAll && aTester.testFindAll(101, 800, hashCode, SWISS, 300);
+  aTester.clearData();
+  findAll = findAll && aTester.testFindAll(101, 800, hashCode, CUCKOO, 300);
+  aTester.clearData();
+  // every name has the same hash, findAll must tell the names apart
+  findAll = findAll && aTester.testFindAll(101, 400, sameHash, LINEAR, 100);
+  if (findAll) {
+    cout << "Testing findAll for names stored under many blocks passed !"
+         << endl;
+  } else {
+    cout << "Testing findAll for names stored under many blocks failed!"
+         << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing the grouped storage of files with the same name" << endl;
+  bool grouped = aTester.testGroupedStore(101, 3000, 150, QUADRATIC);
+  aTester.clearData();
+  grouped = grouped && aTester.testGroupedStore(101, 3000, 150, SWISS);
+  aTester.clearData();
+  grouped = grouped && aTester.testGroupedStore(101, 3000, 150, ROBINHOOD);
+  aTester.clearData();
+  grouped = grouped && aTester.testGroupedStore(101, 3000, 150, CUCKOO);
+  aTester.clearData();
+  grouped = grouped && aTester.testGroupedStore(101, 3000, 150, HOPSCOTCH);
+  if (grouped) {
+    cout << "Testing the grouped storage of files with the same name passed !"
+         << endl;
+  } else {
+    cout << "Testing the grouped storage of files with the same name failed!"
+         << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing the lookup of files by their disk block" << endl;
+  bool byBlock =
+      aTester.testBlockIndex(101, 600, hashCode, QUADRATIC, FILESTORE);
+  aTester.clearData();
+  byBlock =
+      byBlock && aTester.testBlockIndex(101, 600, hashCode, SWISS, FILESTORE);
+  aTester.clearData();
+  byBlock =
+      byBlock && aTester.testBlockIndex(101, 600, hashCode, CUCKOO, FILESTORE);
+  aTester.clearData();
+  byBlock = byBlock &&
+            aTester.testBlockIndex(101, 600, hashCode, HOPSCOTCH, GROUPSTORE);
+  aTester.clearData();
+  byBlock =
+      byBlock && aTester.testBlockIndex(101, 600, hashCode, LINEAR, GROUPSTORE);
+  aTester.clearData();
+  // every name has the same hash, a name slot of the block is found by a scan
+  byBlock = byBlock &&
+            aTester.testBlockIndex(101, 300, sameHash, QUADRATIC, GROUPSTORE);
+  if (byBlock) {
+    cout << "Testing the lookup of files by their disk block passed !" << endl;
+  } else {
+    cout << "Testing the lookup of files by their disk block failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing the block allocator" << endl;
+  bool allocator = aTester.testBlockAllocator(2000, QUADRATIC);
+  aTester.clearData();
+  allocator = allocator && aTester.testBlockAllocator(2000, ROBINHOOD);
+  if (allocator) {
+    cout << "Testing the block allocator passed !" << endl;
+  } else {
+    cout << "Testing the block allocator failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing the directory tree" << endl;
+  if (aTester.testDirTree(1000, QUADRATIC) &&
+      aTester.testDirTree(1000, SWISS)) {
+    cout << "Testing the directory tree passed !" << endl;
+  } else {
+    cout << "Testing the directory tree failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing a full directory tree" << endl;
+  if (aTester.testDirTreeFull(CUCKOO) && aTester.testDirTreeFull(HOPSCOTCH)) {
+    cout << "Testing a full directory tree passed !" << endl;
+  } else {
+    cout << "Testing a full directory tree failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing prefix scans of the ordered name index" << endl;
+  bool ordered = aTester.testOrderedIndex(5000, QUADRATIC, FILESTORE);
+  aTester.clearData();
+  ordered = ordered && aTester.testOrderedIndex(5000, ROBINHOOD, FILESTORE);
+  aTester.clearData();
+  ordered = ordered && aTester.testOrderedIndex(5000, SWISS, GROUPSTORE);
+  if (ordered) {
+    cout << "Testing prefix scans of the ordered name index passed !" << endl;
+  } else {
+    cout << "Testing prefix scans of the ordered name index failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing the live file iterator during a migration" << endl;
+  bool live = aTester.testLiveIterator(3000, QUADRATIC, FILESTORE);
+  aTester.clearData();
+  live = live && aTester.testLiveIterator(3000, SWISS, GROUPSTORE);
+  aTester.clearData();
+  live = live && aTester.testLiveIterator(3000, ROBINHOOD, FILESTORE);
+  if (live) {
+    cout << "Testing the live file iterator during a migration passed !"
+         << endl;
+  } else {
+    cout << "Testing the live file iterator during a migration failed!"
+         << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing inserts while a walk holds the migration" << endl;
+  bool walkInserts = aTester.testWalkInserts(5000, QUADRATIC, FILESTORE);
+  aTester.clearData();
+  walkInserts = walkInserts && aTester.testWalkInserts(5000, SWISS, GROUPSTORE);
+  aTester.clearData();
+  walkInserts = walkInserts && aTester.testWalkInserts(5000, LINEAR, FILESTORE);
+  if (walkInserts) {
+    cout << "Testing inserts while a walk holds the migration passed !" << endl;
+  } else {
+    cout << "Testing inserts while a walk holds the migration failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing bulkLoad while a walk holds the migration" << endl;
+  bool walkLoad = aTester.testWalkBatch(5000, QUADRATIC, FILESTORE, true);
+  aTester.clearData();
+  walkLoad = walkLoad && aTester.testWalkBatch(5000, SWISS, GROUPSTORE, true);
+  aTester.clearData();
+  walkLoad = walkLoad && aTester.testWalkBatch(5000, CUCKOO, FILESTORE, true);
+  if (walkLoad) {
+    cout << "Testing bulkLoad while a walk holds the migration passed !"
+         << endl;
+  } else {
+    cout << "Testing bulkLoad while a walk holds the migration failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing insertBatch while a walk holds the migration" << endl;
+  bool walkBatch = aTester.testWalkBatch(5000, QUADRATIC, FILESTORE, false);
+  aTester.clearData();
+  walkBatch = walkBatch && aTester.testWalkBatch(5000, ROBINHOOD, GROUPSTORE,
+                                                 false);
+  aTester.clearData();
+  walkBatch = walkBatch && aTester.testWalkBatch(5000, HOPSCOTCH, FILESTORE,
+                                                 false);
+  if (walkBatch) {
+    cout << "Testing insertBatch while a walk holds the migration passed !"
+         << endl;
+  } else {
+    cout << "Testing insertBatch while a walk holds the migration failed!"
+         << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing bulkLoad during a migration" << endl;
+  bool bulk = aTester.testBulkLoad(5000, QUADRATIC, FILESTORE);
+  aTester.clearData();
+  bulk = bulk && aTester.testBulkLoad(5000, HOPSCOTCH, FILESTORE);
+  aTester.clearData();
+  bulk = bulk && aTester.testBulkLoad(5000, CUCKOO, FILESTORE);
+  aTester.clearData();
+  bulk = bulk && aTester.testBulkLoad(5000, SWISS, GROUPSTORE);
+  if (bulk) {
+    cout << "Testing bulkLoad during a migration passed !" << endl;
+  } else {
+    cout << "Testing bulkLoad during a migration failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing the batch lookup during a migration" << endl;
+  bool batch = aTester.testFindFiles(3000, QUADRATIC, FILESTORE);
+  aTester.clearData();
+  batch = batch && aTester.testFindFiles(3000, CUCKOO, FILESTORE);
+  aTester.clearData();
+  batch = batch && aTester.testFindFiles(3000, ROBINHOOD, GROUPSTORE);
+  if (batch) {
+    cout << "Testing the batch lookup during a migration passed !" << endl;
+  } else {
+    cout << "Testing the batch lookup during a migration failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing insertBatch and removeBatch" << endl;
+  bool batches = aTester.testBatches(6000, QUADRATIC, FILESTORE);
+  aTester.clearData();
+  batches = batches && aTester.testBatches(6000, HOPSCOTCH, FILESTORE);
+  aTester.clearData();
+  batches = batches && aTester.testBatches(6000, SWISS, GROUPSTORE);
+  if (batches) {
+    cout << "Testing insertBatch and removeBatch passed !" << endl;
+  } else {
+    cout << "Testing insertBatch and removeBatch failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing reserve and shrink_to_fit" << endl;
+  bool reserve = aTester.testReserve(20000, QUADRATIC, false);
+  aTester.clearData();
+  reserve = reserve && aTester.testReserve(20000, SWISS, true);
+  aTester.clearData();
+  reserve = reserve && aTester.testReserve(20000, HOPSCOTCH, true);
+  aTester.clearData();
+  reserve = reserve && aTester.testReserve(20000, CUCKOO, false);
+  if (reserve) {
+    cout << "Testing reserve and shrink_to_fit passed !" << endl;
+  } else {
+    cout << "Testing reserve and shrink_to_fit failed!" << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing the operations that finish a bounded migration" << endl;
+  bool finish = aTester.testBoundedFinish(3000, QUADRATIC, SLOTSTEP, 1);
+  aTester.clearData();
+  finish = finish && aTester.testBoundedFinish(3000, CUCKOO, MOVESTEP, 1);
+  aTester.clearData();
+  finish = finish && aTester.testBoundedFinish(3000, HOPSCOTCH, TIMESTEP, 1);
+  aTester.clearData();
+  finish = finish && aTester.testBoundedFinish(3000, SWISS, SLOTSTEP, 4);
+  if (finish) {
+    cout << "Testing the operations that finish a bounded migration passed !"
+         << endl;
+  } else {
+    cout << "Testing the operations that finish a bounded migration failed!"
+         << endl;
+  }
+  aTester.clearData();
+
+  cout << "Testing the budget of a migration step" << endl;
+  bool step = aTester.testMigrationStep(30000, QUADRATIC, SLOTSTEP, 64);
+  aTester.clearData();
+  step = step && aTester.testMigrationStep(30000, SWISS, MOVESTEP, 8);
+  aTester.clearData();
+  step = step && aTester.testMigrationStep(30000, HOPSCOTCH, SLOTSTEP, 16);
+  aTester.clearData();
+  step = step && aTester.testMigrationStep(30000, LINEAR, TIMESTEP, 2000);
+  if (step) {
+    cout << "Testing the budget of a migration step passed !" << endl;
+  } else {
+    cout << "Testing the budget of a migration step failed!" << endl;
   }
   return 0;
 }